@@ -0,0 +1,300 @@
+#include "SM4_Bitslice.h"
+#include "sm4.h"
+#include "SM4_SIMD.h"
+#include <cstring>
+
+#define SM4_BS_INLINE inline __attribute__((always_inline))
+
+namespace {
+
+// 擦除缓冲区，volatile 写防止被编译器当作死存储优化掉
+void secureZero(void* p, size_t n) {
+    volatile uint8_t* v = static_cast<volatile uint8_t*>(p);
+    while (n--) *v++ = 0;
+}
+
+// 128/256 位向量类型，XOR/AND/NOT 由编译器映射到 SSE2/AVX2 指令
+typedef uint64_t V128 __attribute__((vector_size(16)));
+typedef uint64_t V256 __attribute__((vector_size(32)));
+// 少量分组的路径：4 个 32 位通道，每个通道是一个分组的一个字
+typedef uint32_t W4 __attribute__((vector_size(16)));
+
+// 不足这个数目的尾部分组走按字节切片的窄路径，否则补齐到 64 个分组
+constexpr size_t NARROW_MAX = 24;
+
+/*
+ * S 盒电路参数（由 SM4 S 盒 S(x) = A·I(A·x + C) + C 推导，I 为 GF(2^8)/0x1F5 上的求逆）：
+ *   PRE  = T·A，把输入映射到塔域 GF((2^4)^2)，GF(16) = GF(2)[z]/(z^4+z+1)，
+ *          GF(256) = GF(16)[y]/(y^2+y+λ)，λ = 9；高半字节为 y 的系数
+ *   POST = A·T^-1，映射回 SM4 的域
+ * 矩阵按行给出：第 i 个输出位 = 行掩码所选输入位的异或
+ */
+constexpr uint8_t PRE_ROWS[8]  = { 0xF0, 0x72, 0xD6, 0x18, 0x93, 0x40, 0xC4, 0x7F };
+constexpr uint8_t PRE_CONST    = 0xAF;
+constexpr uint8_t POST_ROWS[8] = { 0x33, 0x65, 0x14, 0xB5, 0x8A, 0x2A, 0x07, 0x29 };
+constexpr uint8_t POST_CONST   = 0xD3;
+
+// 求逆所需的 GF(16) 线性映射：λ·a^2 与 a^2
+constexpr uint8_t LAMBDA_SQ_ROWS[4] = { 0x1, 0xA, 0x8, 0x5 };
+constexpr uint8_t SQ_ROWS[4]        = { 0x5, 0x4, 0xA, 0x8 };
+
+/* GF(2) 上的线性变换 + 常数，rows/c 均为编译期常量，循环展开后只剩异或与取反 */
+template <typename W, int N>
+SM4_BS_INLINE void linear(const uint8_t (&rows)[N], uint8_t c, const W* in, W* out) {
+#pragma GCC unroll 8
+    for (int i = 0; i < N; ++i) {
+        W r = W{};
+#pragma GCC unroll 8
+        for (int j = 0; j < N; ++j) {
+            if ((rows[i] >> j) & 1) r ^= in[j];
+        }
+        out[i] = ((c >> i) & 1) ? ~r : r;
+    }
+}
+
+/* GF(16) 乘法：多项式乘积后按 z^4 = z + 1 约减 */
+template <typename W>
+SM4_BS_INLINE void gf16Mul(const W* a, const W* b, W* r) {
+    W p0 = a[0] & b[0];
+    W p1 = (a[0] & b[1]) ^ (a[1] & b[0]);
+    W p2 = (a[0] & b[2]) ^ (a[1] & b[1]) ^ (a[2] & b[0]);
+    W p3 = (a[0] & b[3]) ^ (a[1] & b[2]) ^ (a[2] & b[1]) ^ (a[3] & b[0]);
+    W p4 = (a[1] & b[3]) ^ (a[2] & b[2]) ^ (a[3] & b[1]);
+    W p5 = (a[2] & b[3]) ^ (a[3] & b[2]);
+    W p6 = a[3] & b[3];
+    r[0] = p0 ^ p4;
+    r[1] = p1 ^ p4 ^ p5;
+    r[2] = p2 ^ p5 ^ p6;
+    r[3] = p3 ^ p6;
+}
+
+/* GF(16) 求逆：各输出位的代数正规型（0 映射到 0） */
+template <typename W>
+SM4_BS_INLINE void gf16Inv(const W* x, W* r) {
+    W x01 = x[0] & x[1], x02 = x[0] & x[2], x03 = x[0] & x[3];
+    W x12 = x[1] & x[2], x13 = x[1] & x[3], x23 = x[2] & x[3];
+    W x012 = x01 & x[2], x013 = x01 & x[3], x023 = x02 & x[3], x123 = x12 & x[3];
+    r[0] = x[0] ^ x[1] ^ x[2] ^ x[3] ^ x02 ^ x12 ^ x012 ^ x123;
+    r[1] = x[3] ^ x01 ^ x02 ^ x12 ^ x13 ^ x013;
+    r[2] = x[2] ^ x[3] ^ x01 ^ x02 ^ x03 ^ x023;
+    r[3] = x[1] ^ x[2] ^ x[3] ^ x03 ^ x13 ^ x23 ^ x123;
+}
+
+/*
+ * 位切片 S 盒：x[0..7] 为一个字节的 8 个比特切片（x[0] 为最低位），原地替换
+ * 塔域求逆：(h·y + l)^-1 = (h·d^-1)·y + (h + l)·d^-1，d = λ·h^2 + h·l + l^2
+ */
+template <typename W>
+SM4_BS_INLINE void sbox(W* x) {
+    W u[8];
+    linear(PRE_ROWS, PRE_CONST, x, u);
+    const W* l = u;
+    const W* h = u + 4;
+
+    W d[4], hl[4], t0[4], t1[4];
+    gf16Mul(h, l, hl);
+    linear(LAMBDA_SQ_ROWS, 0, h, t0);
+    linear(SQ_ROWS, 0, l, t1);
+    for (int i = 0; i < 4; ++i) d[i] = hl[i] ^ t0[i] ^ t1[i];
+
+    W di[4], sum[4], v[8];
+    gf16Inv(d, di);
+    for (int i = 0; i < 4; ++i) sum[i] = h[i] ^ l[i];
+    gf16Mul(sum, di, v);
+    gf16Mul(h, di, v + 4);
+
+    linear(POST_ROWS, POST_CONST, v, x);
+}
+
+/* 64×64 位矩阵转置：转置后 a[i] 的第 j 位 = 转置前 a[j] 的第 i 位 */
+SM4_BS_INLINE void transpose64(uint64_t a[64]) {
+    uint64_t m = 0x00000000FFFFFFFFull;
+    for (int j = 32; j != 0; j >>= 1, m ^= m << j) {
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+            a[k] ^= t << j;
+            a[k | j] ^= t;
+        }
+    }
+}
+
+/*
+ * 处理 64·G 个分组（G = sizeof(W) / 8）
+ * 状态 X[w][b] 为所有分组第 w 个字第 b 位的切片；第 g 组 64 个分组占用切片的第 g 个 64 位元素
+ */
+template <typename W>
+SM4_BS_INLINE void cryptBatch(const uint32_t rk[32], const uint8_t* in, uint8_t* out) {
+    constexpr int G = sizeof(W) / sizeof(uint64_t);
+    W X[4][32];
+    uint64_t* lanes = reinterpret_cast<uint64_t*>(X);
+    uint64_t a[64];
+
+    // 载入：一次转置 64 个分组的两个字（高 32 位为前一个字）
+    for (int g = 0; g < G; ++g) {
+        for (int w = 0; w < 4; w += 2) {
+            for (int j = 0; j < 64; ++j) {
+                const uint8_t* p = in + (g * 64 + j) * SM4::BLOCK_SIZE + w * 4;
+                a[j] = (uint64_t(SM4::jointBytes(p)) << 32) | SM4::jointBytes(p + 4);
+            }
+            transpose64(a);
+            for (int b = 0; b < 32; ++b) {
+                lanes[(w * 32 + b) * G + g] = a[32 + b];
+                lanes[((w + 1) * 32 + b) * G + g] = a[b];
+            }
+        }
+    }
+
+    for (int i = 0; i < 32; ++i) {
+        W* x0 = X[i & 3];
+        const W* x1 = X[(i + 1) & 3];
+        const W* x2 = X[(i + 2) & 3];
+        const W* x3 = X[(i + 3) & 3];
+
+        // 轮密钥的每一位扩展成全 0 / 全 1 掩码，不产生与密钥相关的分支
+        W t[32];
+        for (int b = 0; b < 32; ++b) {
+            uint64_t k = 0 - uint64_t((rk[i] >> b) & 1);
+            t[b] = x1[b] ^ x2[b] ^ x3[b] ^ k;
+        }
+        for (int k = 0; k < 4; ++k) {
+            sbox(t + 8 * k);
+        }
+        // L：循环左移 n 位后第 b 位来自第 b - n 位
+        for (int b = 0; b < 32; ++b) {
+            x0[b] ^= t[b] ^ t[(b + 30) & 31] ^ t[(b + 22) & 31] ^ t[(b + 14) & 31] ^ t[(b + 8) & 31];
+        }
+    }
+
+    // 反序变换 R：32 轮后 X[0..3] = (X32, X33, X34, X35)，输出 (X35, X34, X33, X32)
+    for (int g = 0; g < G; ++g) {
+        for (int w = 0; w < 4; w += 2) {
+            for (int b = 0; b < 32; ++b) {
+                a[32 + b] = lanes[((3 - w) * 32 + b) * G + g];
+                a[b] = lanes[((2 - w) * 32 + b) * G + g];
+            }
+            transpose64(a);
+            for (int j = 0; j < 64; ++j) {
+                uint8_t* p = out + (g * 64 + j) * SM4::BLOCK_SIZE + w * 4;
+                SM4::splitInt(uint32_t(a[j] >> 32), p);
+                SM4::splitInt(uint32_t(a[j]), p + 4);
+            }
+        }
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2"))) void cryptBatch256(const uint32_t rk[32], const uint8_t* in, uint8_t* out) {
+    cryptBatch<V256>(rk, in, out);
+}
+#endif
+
+/*
+ * 窄路径的 S 盒与 L：不转置分组，每个 32 位通道内的 4 个字节同时过 S 盒电路
+ * 切片 s[b] 取各字节的第 b 位，只用到每个通道的第 0/8/16/24 位，其余位的结果丢弃
+ */
+SM4_BS_INLINE W4 tNarrow(W4 t) {
+    const W4 low = W4{} + 0x01010101u;
+    W4 s[8];
+    for (int b = 0; b < 8; ++b) s[b] = (t >> b) & low;
+    sbox(s);
+    W4 x = W4{};
+    for (int b = 0; b < 8; ++b) x |= (s[b] & low) << b;
+    return x ^ ((x << 2) | (x >> 30)) ^ ((x << 10) | (x >> 22)) ^ ((x << 18) | (x >> 14)) ^ ((x << 24) | (x >> 8));
+}
+
+/* 至多 4 个分组，每个分组占一个通道；空闲通道为 0，结果不写出 */
+void cryptNarrow(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    W4 X[4] = {};
+    for (size_t k = 0; k < nblocks; ++k) {
+        for (int w = 0; w < 4; ++w) X[w][k] = SM4::jointBytes(in + k * SM4::BLOCK_SIZE + w * 4);
+    }
+    for (int i = 0; i < 32; ++i) {
+        X[i & 3] ^= tNarrow(X[(i + 1) & 3] ^ X[(i + 2) & 3] ^ X[(i + 3) & 3] ^ rk[i]);
+    }
+    for (size_t k = 0; k < nblocks; ++k) {
+        for (int w = 0; w < 4; ++w) SM4::splitInt(X[3 - w][k], out + k * SM4::BLOCK_SIZE + w * 4);
+    }
+}
+
+} // namespace
+
+void SM4_Bitsliced::crypt64(const uint32_t rk[32], const uint8_t* in, uint8_t* out) {
+    cryptBatch<uint64_t>(rk, in, out);
+}
+
+void SM4_Bitsliced::crypt128(const uint32_t rk[32], const uint8_t* in, uint8_t* out) {
+    cryptBatch<V128>(rk, in, out);
+}
+
+void SM4_Bitsliced::crypt256(const uint32_t rk[32], const uint8_t* in, uint8_t* out) {
+#if defined(__x86_64__) || defined(__i386__)
+    cryptBatch256(rk, in, out);
+#else
+    crypt128(rk, in, out);
+    crypt128(rk, in + 128 * SM4::BLOCK_SIZE, out + 128 * SM4::BLOCK_SIZE);
+#endif
+}
+
+void SM4_Bitsliced::cryptFew(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    for (; nblocks; ) {
+        size_t n = nblocks < 4 ? nblocks : 4;
+        cryptNarrow(rk, in, out, n);
+        in += n * SM4::BLOCK_SIZE;
+        out += n * SM4::BLOCK_SIZE;
+        nblocks -= n;
+    }
+}
+
+void SM4_Bitsliced::cryptBlocks(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    if (SM4_SIMD::hasAVX2()) {
+        for (; nblocks >= 256; nblocks -= 256, in += 256 * SM4::BLOCK_SIZE, out += 256 * SM4::BLOCK_SIZE) {
+            crypt256(rk, in, out);
+        }
+    }
+    for (; nblocks >= 128; nblocks -= 128, in += 128 * SM4::BLOCK_SIZE, out += 128 * SM4::BLOCK_SIZE) {
+        crypt128(rk, in, out);
+    }
+    for (; nblocks >= 64; nblocks -= 64, in += 64 * SM4::BLOCK_SIZE, out += 64 * SM4::BLOCK_SIZE) {
+        crypt64(rk, in, out);
+    }
+    if (nblocks && nblocks < NARROW_MAX) {
+        cryptFew(rk, in, out, nblocks);
+    } else if (nblocks) {
+        uint8_t buf[64 * SM4::BLOCK_SIZE] = {0};
+        std::memcpy(buf, in, nblocks * SM4::BLOCK_SIZE);
+        crypt64(rk, buf, buf);
+        std::memcpy(out, buf, nblocks * SM4::BLOCK_SIZE);
+        // 缓冲区里是明文或密钥流
+        secureZero(buf, sizeof(buf));
+    }
+}
+
+SM4_Bitsliced::SM4_Bitsliced(const uint8_t key[16]) {
+    SM4::initContext(key, ctx);
+}
+
+SM4_Bitsliced::SM4_Bitsliced(const std::vector<unsigned char>& key)
+    : SM4_Bitsliced(key.data()) {}
+
+SM4_Bitsliced::SM4_Bitsliced(const SM4Context& ctx)
+    : ctx(ctx) {}
+
+void SM4_Bitsliced::encrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const {
+    cryptBlocks(ctx.rk_enc, in, out, nblocks);
+}
+
+void SM4_Bitsliced::decrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const {
+    cryptBlocks(ctx.rk_dec, in, out, nblocks);
+}
+
+std::vector<unsigned char> SM4_Bitsliced::encrypt(const std::vector<unsigned char>& plaintext) const {
+    std::vector<unsigned char> output(SM4::BLOCK_SIZE);
+    encrypt_blocks(plaintext.data(), output.data(), 1);
+    return output;
+}
+
+std::vector<unsigned char> SM4_Bitsliced::decrypt(const std::vector<unsigned char>& ciphertext) const {
+    std::vector<unsigned char> output(SM4::BLOCK_SIZE);
+    decrypt_blocks(ciphertext.data(), output.data(), 1);
+    return output;
+}
@@ -0,0 +1,50 @@
+#ifndef SM4_BITSLICE_H
+#define SM4_BITSLICE_H
+
+#include "sm4.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * SM4_Bitsliced
+ * 位切片（bitslice）实现：把一批互相独立的分组按比特转置，寄存器的每一位对应一个分组，
+ * S 盒改用布尔电路（塔域 GF((2^4)^2) 求逆 + 前后仿射变换）计算，
+ * 只有 XOR/AND/NOT 运算，没有任何查表和数据相关分支，可抵抗缓存计时攻击。
+ *
+ * 一批的大小由寄存器宽度决定：64 位整数一次 64 个分组，128 位向量一次 128 个，
+ * AVX2 的 256 位向量一次 256 个。不足一批的尾部补齐后按最小批处理。
+ */
+class SM4_Bitsliced {
+public:
+    explicit SM4_Bitsliced(const std::vector<unsigned char>& key);
+    explicit SM4_Bitsliced(const uint8_t key[16]);
+    explicit SM4_Bitsliced(const SM4Context& ctx);
+
+    // 单分组接口，与 SM4 相同
+    std::vector<unsigned char> encrypt(const std::vector<unsigned char>& plaintext) const;
+    std::vector<unsigned char> decrypt(const std::vector<unsigned char>& ciphertext) const;
+
+    // 批量 ECB 接口，与 SM4::encrypt_blocks / decrypt_blocks 相同
+    void encrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const;
+    void decrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const;
+
+    /*
+     * 批量分组核心：按 rk[0..31] 的顺序执行 32 轮
+     * 优先用最宽的批（AVX2 可用时 256，否则 128），尾部降到 64 分组一批；
+     * 不足 24 个的尾部不补齐，改走 cryptFew
+     */
+    static void cryptBlocks(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks);
+
+    // 固定批大小的内核：处理恰好 64 / 128 / 256 个分组，256 路在 x86 上需要 AVX2，其他平台拆成两批 128
+    static void crypt64(const uint32_t rk[32], const uint8_t* in, uint8_t* out);
+    static void crypt128(const uint32_t rk[32], const uint8_t* in, uint8_t* out);
+    static void crypt256(const uint32_t rk[32], const uint8_t* in, uint8_t* out);
+    // 少量分组的内核：每 4 个分组一批，S 盒同样是布尔电路，不查表；任意 nblocks
+    static void cryptFew(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks);
+
+private:
+    SM4Context ctx; // 加密与逆序的解密轮密钥
+};
+
+#endif // SM4_BITSLICE_H
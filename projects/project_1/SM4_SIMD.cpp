@@ -1,89 +1,742 @@
-#include <iostream>
+#include "SM4_SIMD.h"
+#include "sm4.h"
+#include "SM4_T_Table.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SM4_SIMD_X86 1
 #include <immintrin.h>
-#include <vector>
-#include <cstdint>
+#endif
+
+#ifdef SM4_SIMD_X86
+namespace {
+
+/*
+ * S 盒的前后仿射变换，按半字节拆成两张 16 项表供 PSHUFB 使用：
+ *     f(x) = LO[x & 0x0F] ^ HI[x >> 4]
+ * PRE  把 SM4 的 A·x + C 同构映射到 AES 所用的 GF(2^8)/(x^8+x^4+x^3+x+1)，
+ * POST 撤销 AES S 盒自带的仿射变换，再映射回 SM4 的域并做 A·y + C。
+ */
+alignas(16) const uint8_t PRE_LO[16] = {
+    0x3E, 0xB2, 0x0E, 0x82, 0xBB, 0x37, 0x8B, 0x07, 0xA1, 0x2D, 0x91, 0x1D, 0x24, 0xA8, 0x14, 0x98
+};
+alignas(16) const uint8_t PRE_HI[16] = {
+    0x00, 0xDC, 0x2E, 0xF2, 0xC5, 0x19, 0xEB, 0x37, 0x08, 0xD4, 0x26, 0xFA, 0xCD, 0x11, 0xE3, 0x3F
+};
+alignas(16) const uint8_t POST_LO[16] = {
+    0x6C, 0xD4, 0xA6, 0x1E, 0x52, 0xEA, 0x98, 0x20, 0x0B, 0xB3, 0xC1, 0x79, 0x35, 0x8D, 0xFF, 0x47
+};
+alignas(16) const uint8_t POST_HI[16] = {
+    0x00, 0xE0, 0x50, 0xB0, 0x9D, 0x7D, 0xCD, 0x2D, 0xC0, 0x20, 0x90, 0x70, 0x5D, 0xBD, 0x0D, 0xED
+};
+
+// AESENCLAST 先做 ShiftRows 再做 SubBytes，预先做一次逆 ShiftRows 抵消字节搬移
+alignas(16) const uint8_t INV_SHIFT_ROWS[16] = {
+    0x00, 0x0D, 0x0A, 0x07, 0x04, 0x01, 0x0E, 0x0B, 0x08, 0x05, 0x02, 0x0F, 0x0C, 0x09, 0x06, 0x03
+};
+
+// 每个 32 位字内的字节序翻转（SM4 按大端序取字）
+alignas(16) const uint8_t BSWAP32[16] = {
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+};
+
+// 32 位字循环左移 8/16/24 位的字节置换
+alignas(16) const uint8_t ROL8[16]  = { 3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14 };
+alignas(16) const uint8_t ROL16[16] = { 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13 };
+alignas(16) const uint8_t ROL24[16] = { 1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12 };
+
+/* ---------------- SSSE3 + AES-NI：一次 4 个分组 ---------------- */
 
-alignas(16) const uint8_t SM4_SBOX[16][16] = {
-    // 可从原始 SBOX 填入展开为 16x16 二维表，用于 PSHUFB 查询
-    // 示例略去，可用你原来的 SBOX 填充
+#define SM4_SSE __attribute__((target("ssse3,aes")))
+
+struct ConstSSE {
+    __m128i pre_lo, pre_hi, post_lo, post_hi, inv_sr, mask4, rol8, rol16, rol24, bswap;
+
+    SM4_SSE ConstSSE()
+        : pre_lo(load128(PRE_LO)), pre_hi(load128(PRE_HI)),
+          post_lo(load128(POST_LO)), post_hi(load128(POST_HI)),
+          inv_sr(load128(INV_SHIFT_ROWS)), mask4(_mm_set1_epi8(0x0F)),
+          rol8(load128(ROL8)), rol16(load128(ROL16)), rol24(load128(ROL24)), bswap(load128(BSWAP32)) {}
+
+    static SM4_SSE __m128i load128(const uint8_t t[16]) {
+        return _mm_load_si128(reinterpret_cast<const __m128i*>(t));
+    }
 };
 
-inline __m128i sboxTransform(__m128i input) {
-    // 简化处理：逐字节查表实现 S-box，真实优化可用 GFNI 或 PSHUFB
-    uint8_t tmp[16], out[16];
-    _mm_storeu_si128((__m128i*)tmp, input);
-    for (int i = 0; i < 16; i++) {
-        uint8_t b = tmp[i];
-        out[i] = SM4_SBOX[b >> 4][b & 0x0F];
+SM4_SSE inline __m128i affine128(__m128i x, __m128i lo_t, __m128i hi_t, __m128i mask4) {
+    __m128i lo = _mm_and_si128(x, mask4);
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(x, 4), mask4);
+    return _mm_xor_si128(_mm_shuffle_epi8(lo_t, lo), _mm_shuffle_epi8(hi_t, hi));
+}
+
+SM4_SSE inline __m128i tSSE(__m128i x, const ConstSSE& c) {
+    x = affine128(x, c.pre_lo, c.pre_hi, c.mask4);
+    x = _mm_aesenclast_si128(_mm_shuffle_epi8(x, c.inv_sr), _mm_setzero_si128());
+    __m128i b = affine128(x, c.post_lo, c.post_hi, c.mask4);
+    __m128i t = _mm_xor_si128(b, _mm_xor_si128(_mm_shuffle_epi8(b, c.rol8), _mm_shuffle_epi8(b, c.rol16)));
+    t = _mm_or_si128(_mm_slli_epi32(t, 2), _mm_srli_epi32(t, 30));
+    return _mm_xor_si128(_mm_xor_si128(b, _mm_shuffle_epi8(b, c.rol24)), t);
+}
+
+SM4_SSE inline void transposeSSE(__m128i& x0, __m128i& x1, __m128i& x2, __m128i& x3) {
+    __m128i t0 = _mm_unpacklo_epi32(x0, x1);
+    __m128i t1 = _mm_unpackhi_epi32(x0, x1);
+    __m128i t2 = _mm_unpacklo_epi32(x2, x3);
+    __m128i t3 = _mm_unpackhi_epi32(x2, x3);
+    x0 = _mm_unpacklo_epi64(t0, t2);
+    x1 = _mm_unpackhi_epi64(t0, t2);
+    x2 = _mm_unpacklo_epi64(t1, t3);
+    x3 = _mm_unpackhi_epi64(t1, t3);
+}
+
+SM4_SSE void crypt4(const uint32_t rk[32], const uint8_t* in, uint8_t* out, const ConstSSE& c) {
+    const __m128i* p = reinterpret_cast<const __m128i*>(in);
+    __m128i x0 = _mm_shuffle_epi8(_mm_loadu_si128(p), c.bswap);
+    __m128i x1 = _mm_shuffle_epi8(_mm_loadu_si128(p + 1), c.bswap);
+    __m128i x2 = _mm_shuffle_epi8(_mm_loadu_si128(p + 2), c.bswap);
+    __m128i x3 = _mm_shuffle_epi8(_mm_loadu_si128(p + 3), c.bswap);
+    transposeSSE(x0, x1, x2, x3);
+
+    for (int i = 0; i < 32; i += 4) {
+        x0 = _mm_xor_si128(x0, tSSE(_mm_xor_si128(_mm_xor_si128(x1, x2), _mm_xor_si128(x3, _mm_set1_epi32(int(rk[i])))), c));
+        x1 = _mm_xor_si128(x1, tSSE(_mm_xor_si128(_mm_xor_si128(x2, x3), _mm_xor_si128(x0, _mm_set1_epi32(int(rk[i + 1])))), c));
+        x2 = _mm_xor_si128(x2, tSSE(_mm_xor_si128(_mm_xor_si128(x3, x0), _mm_xor_si128(x1, _mm_set1_epi32(int(rk[i + 2])))), c));
+        x3 = _mm_xor_si128(x3, tSSE(_mm_xor_si128(_mm_xor_si128(x0, x1), _mm_xor_si128(x2, _mm_set1_epi32(int(rk[i + 3])))), c));
+    }
+
+    transposeSSE(x3, x2, x1, x0);
+    __m128i* q = reinterpret_cast<__m128i*>(out);
+    _mm_storeu_si128(q, _mm_shuffle_epi8(x3, c.bswap));
+    _mm_storeu_si128(q + 1, _mm_shuffle_epi8(x2, c.bswap));
+    _mm_storeu_si128(q + 2, _mm_shuffle_epi8(x1, c.bswap));
+    _mm_storeu_si128(q + 3, _mm_shuffle_epi8(x0, c.bswap));
+}
+
+/*
+ * 单个分组：每个字广播到 XMM 的 4 个通道
+ * 各通道相同时 AESENCLAST 的 ShiftRows 只在通道间搬移同一字节位置，结果不变，省去逆 ShiftRows；
+ * 串行链上每轮都要等上一轮的结果，耗时取决于 S 盒与 L 的延迟而不是吞吐，所以不转置
+ */
+SM4_SSE inline __m128i lSSE(__m128i b, const ConstSSE& c) {
+    __m128i t = _mm_xor_si128(b, _mm_xor_si128(_mm_shuffle_epi8(b, c.rol8), _mm_shuffle_epi8(b, c.rol16)));
+    t = _mm_or_si128(_mm_slli_epi32(t, 2), _mm_srli_epi32(t, 30));
+    return _mm_xor_si128(_mm_xor_si128(b, _mm_shuffle_epi8(b, c.rol24)), t);
+}
+
+SM4_SSE inline __m128i tSerial(__m128i x, const ConstSSE& c) {
+    x = affine128(x, c.pre_lo, c.pre_hi, c.mask4);
+    x = _mm_aesenclast_si128(x, _mm_setzero_si128());
+    return lSSE(affine128(x, c.post_lo, c.post_hi, c.mask4), c);
+}
+
+// 上一轮刚算出的 c 最后异或，关键路径上只有一次 XOR
+SM4_SSE inline __m128i roundInput(__m128i a, __m128i b, __m128i c, uint32_t rk) {
+    return _mm_xor_si128(_mm_xor_si128(_mm_xor_si128(a, b), _mm_set1_epi32(int(rk))), c);
+}
+
+SM4_SSE inline void storeSerial(__m128i x0, __m128i x1, __m128i x2, __m128i x3, uint8_t* out) {
+    SM4::splitInt(uint32_t(_mm_cvtsi128_si32(x3)), out);
+    SM4::splitInt(uint32_t(_mm_cvtsi128_si32(x2)), out + 4);
+    SM4::splitInt(uint32_t(_mm_cvtsi128_si32(x1)), out + 8);
+    SM4::splitInt(uint32_t(_mm_cvtsi128_si32(x0)), out + 12);
+}
+
+SM4_SSE void crypt1(const uint32_t rk[32], const uint8_t* in, uint8_t* out, const ConstSSE& c) {
+    __m128i x0 = _mm_set1_epi32(int(SM4::jointBytes(in)));
+    __m128i x1 = _mm_set1_epi32(int(SM4::jointBytes(in + 4)));
+    __m128i x2 = _mm_set1_epi32(int(SM4::jointBytes(in + 8)));
+    __m128i x3 = _mm_set1_epi32(int(SM4::jointBytes(in + 12)));
+    for (int i = 0; i < 32; i += 4) {
+        x0 = _mm_xor_si128(x0, tSerial(roundInput(x1, x2, x3, rk[i]), c));
+        x1 = _mm_xor_si128(x1, tSerial(roundInput(x2, x3, x0, rk[i + 1]), c));
+        x2 = _mm_xor_si128(x2, tSerial(roundInput(x3, x0, x1, rk[i + 2]), c));
+        x3 = _mm_xor_si128(x3, tSerial(roundInput(x0, x1, x2, rk[i + 3]), c));
     }
-    return _mm_loadu_si128((__m128i*)out);
+    storeSerial(x0, x1, x2, x3, out);
+}
+
+/* ---------------- AVX2 + AES-NI：一次 8 个分组 ---------------- */
+
+#define SM4_AVX2 __attribute__((target("avx2,aes")))
+
+SM4_AVX2 inline __m256i bcast128(const uint8_t t[16]) {
+    return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(t)));
 }
 
-inline __m128i linearTransform(__m128i sboxOut) {
-    // 使用 VPROLD 模拟 SM4 的移位和 XOR
-    __m128i r1 = _mm_rol_epi32(sboxOut, 2);
-    __m128i r2 = _mm_rol_epi32(sboxOut, 10);
-    __m128i r3 = _mm_rol_epi32(sboxOut, 18);
-    __m128i r4 = _mm_rol_epi32(sboxOut, 24);
+struct ConstAVX2 {
+    __m256i pre_lo, pre_hi, post_lo, post_hi, inv_sr, mask4, rol8, rol16, rol24;
+
+    SM4_AVX2 ConstAVX2()
+        : pre_lo(bcast128(PRE_LO)), pre_hi(bcast128(PRE_HI)),
+          post_lo(bcast128(POST_LO)), post_hi(bcast128(POST_HI)),
+          inv_sr(bcast128(INV_SHIFT_ROWS)), mask4(_mm256_set1_epi8(0x0F)),
+          rol8(bcast128(ROL8)), rol16(bcast128(ROL16)), rol24(bcast128(ROL24)) {}
+};
+
+/* 仿射变换：两次 PSHUFB 查半字节表后异或 */
+SM4_AVX2 inline __m256i affine(__m256i x, __m256i lo_t, __m256i hi_t, __m256i mask4) {
+    __m256i lo = _mm256_and_si256(x, mask4);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), mask4);
+    return _mm256_xor_si256(_mm256_shuffle_epi8(lo_t, lo), _mm256_shuffle_epi8(hi_t, hi));
+}
+
+/* 32 路并行 S 盒 */
+SM4_AVX2 inline __m256i sboxAVX2(__m256i x, const ConstAVX2& c) {
+    x = affine(x, c.pre_lo, c.pre_hi, c.mask4);
+    x = _mm256_shuffle_epi8(x, c.inv_sr);
+    // 无 VAES 时 AESENCLAST 只能处理 128 位，拆成两半
+    __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_aesenclast_si128(_mm256_castsi256_si128(x), zero);
+    __m128i hi = _mm_aesenclast_si128(_mm256_extracti128_si256(x, 1), zero);
+    x = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    return affine(x, c.post_lo, c.post_hi, c.mask4);
+}
 
-    return _mm_xor_si128(
-             _mm_xor_si128(
-                 _mm_xor_si128(sboxOut, r1),
-                 _mm_xor_si128(r2, r3)),
-             r4);
+SM4_AVX2 inline __m256i rol32AVX2(__m256i x, int n) {
+    return _mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - n));
 }
 
-void sm4_encrypt_block(__m128i* state, const __m128i rk[32]) {
+/* T 变换：L(S(x))，L(b) = b ^ (b<<<24) ^ ((b ^ (b<<<8) ^ (b<<<16)) <<< 2) */
+SM4_AVX2 inline __m256i tAVX2(__m256i x, const ConstAVX2& c) {
+    __m256i b = sboxAVX2(x, c);
+    __m256i t = _mm256_xor_si256(b, _mm256_xor_si256(_mm256_shuffle_epi8(b, c.rol8), _mm256_shuffle_epi8(b, c.rol16)));
+    return _mm256_xor_si256(_mm256_xor_si256(b, _mm256_shuffle_epi8(b, c.rol24)), rol32AVX2(t, 2));
+}
+
+/* 每 128 位通道内 4×4 的 32 位字转置（自逆） */
+SM4_AVX2 inline void transposeAVX2(__m256i& x0, __m256i& x1, __m256i& x2, __m256i& x3) {
+    __m256i t0 = _mm256_unpacklo_epi32(x0, x1);
+    __m256i t1 = _mm256_unpackhi_epi32(x0, x1);
+    __m256i t2 = _mm256_unpacklo_epi32(x2, x3);
+    __m256i t3 = _mm256_unpackhi_epi32(x2, x3);
+    x0 = _mm256_unpacklo_epi64(t0, t2);
+    x1 = _mm256_unpackhi_epi64(t0, t2);
+    x2 = _mm256_unpacklo_epi64(t1, t3);
+    x3 = _mm256_unpackhi_epi64(t1, t3);
+}
+
+/* 8 个分组：转置后 x_i 的每个通道是一个分组的第 i 个字 */
+SM4_AVX2 void crypt8(const uint32_t rk[32], const uint8_t* in, uint8_t* out, const ConstAVX2& c) {
+    const __m256i bswap = bcast128(BSWAP32);
+    __m256i x0 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in)), bswap);
+    __m256i x1 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 32)), bswap);
+    __m256i x2 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 64)), bswap);
+    __m256i x3 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 96)), bswap);
+    transposeAVX2(x0, x1, x2, x3);
+
+    for (int i = 0; i < 32; i += 4) {
+        x0 = _mm256_xor_si256(x0, tAVX2(_mm256_xor_si256(_mm256_xor_si256(x1, x2), _mm256_xor_si256(x3, _mm256_set1_epi32(int(rk[i])))), c));
+        x1 = _mm256_xor_si256(x1, tAVX2(_mm256_xor_si256(_mm256_xor_si256(x2, x3), _mm256_xor_si256(x0, _mm256_set1_epi32(int(rk[i + 1])))), c));
+        x2 = _mm256_xor_si256(x2, tAVX2(_mm256_xor_si256(_mm256_xor_si256(x3, x0), _mm256_xor_si256(x1, _mm256_set1_epi32(int(rk[i + 2])))), c));
+        x3 = _mm256_xor_si256(x3, tAVX2(_mm256_xor_si256(_mm256_xor_si256(x0, x1), _mm256_xor_si256(x2, _mm256_set1_epi32(int(rk[i + 3])))), c));
+    }
+
+    // 反序变换 R：输出字顺序为 x3, x2, x1, x0
+    transposeAVX2(x3, x2, x1, x0);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_shuffle_epi8(x3, bswap));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), _mm256_shuffle_epi8(x2, bswap));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 64), _mm256_shuffle_epi8(x1, bswap));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 96), _mm256_shuffle_epi8(x0, bswap));
+}
+
+/*
+ * 8 个密钥的拓展：rk_i = K_i ^ T'(K_{i+1} ^ K_{i+2} ^ K_{i+3} ^ CK_i)，
+ * T' 的线性部分为 L'(b) = b ^ (b<<<13) ^ (b<<<23)。每个通道一个密钥，字直接逐个装入，无需转置
+ */
+SM4_AVX2 void keyExpand8(const uint8_t* keys, SM4Context* ctx, const ConstAVX2& c) {
+    alignas(32) uint32_t w[4][8];
+    for (int k = 0; k < 8; ++k) {
+        for (int j = 0; j < 4; ++j) {
+            w[j][k] = SM4::jointBytes(keys + 16 * k + 4 * j) ^ SM4::FK[j];
+        }
+    }
+    __m256i x0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(w[0]));
+    __m256i x1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(w[1]));
+    __m256i x2 = _mm256_load_si256(reinterpret_cast<const __m256i*>(w[2]));
+    __m256i x3 = _mm256_load_si256(reinterpret_cast<const __m256i*>(w[3]));
+
+    alignas(32) uint32_t rk[32][8];
     for (int i = 0; i < 32; ++i) {
-        __m128i temp = _mm_xor_si128(_mm_xor_si128(state[1], state[2]), _mm_xor_si128(state[3], rk[i]));
-        __m128i sboxOut = sboxTransform(temp);
-        __m128i L = linearTransform(sboxOut);
-        __m128i newX = _mm_xor_si128(state[0], L);
-
-        // 循环更新
-        state[0] = state[1];
-        state[1] = state[2];
-        state[2] = state[3];
-        state[3] = newX;
-    }
-
-    // 输出顺序调整
-    __m128i tmp = state[0];
-    state[0] = state[3];
-    state[3] = tmp;
-    tmp = state[1];
-    state[1] = state[2];
-    state[2] = tmp;
-}
-
-int main() {
-    alignas(16) uint8_t plaintext[16] = {
-        0x01, 0x23, 0x45, 0x67,
-        0x89, 0xAB, 0xCD, 0xEF,
-        0xFE, 0xDC, 0xBA, 0x98,
-        0x76, 0x54, 0x32, 0x10
-    };
-
-    __m128i state[4];
-    for (int i = 0; i < 4; ++i)
-        state[i] = _mm_set_epi32(
-            (plaintext[i * 4 + 0] << 24) | (plaintext[i * 4 + 1] << 16) |
-            (plaintext[i * 4 + 2] << 8) | plaintext[i * 4 + 3],
-            0, 0, 0); // 模拟 32-bit word
-
-    // 示例轮密钥（真实中应通过密钥扩展生成）
-    __m128i rk[32];
-    for (int i = 0; i < 32; ++i) rk[i] = _mm_set1_epi32(0x12345678 + i);
-
-    sm4_encrypt_block(state, rk);
-
-    std::cout << "加密后数据：" << std::hex;
-    for (int i = 0; i < 4; ++i) {
-        uint32_t out;
-        memcpy(&out, &state[i], sizeof(uint32_t));
-        std::cout << out << " ";
-    }
-    std::cout << std::dec << std::endl;
-
-    return 0;
+        __m256i b = sboxAVX2(_mm256_xor_si256(_mm256_xor_si256(x1, x2), _mm256_xor_si256(x3, _mm256_set1_epi32(int(SM4::CK[i])))), c);
+        __m256i t = _mm256_xor_si256(x0, _mm256_xor_si256(b, _mm256_xor_si256(rol32AVX2(b, 13), rol32AVX2(b, 23))));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(rk[i]), t);
+        x0 = x1;
+        x1 = x2;
+        x2 = x3;
+        x3 = t;
+    }
+    for (int k = 0; k < 8; ++k) {
+        for (int i = 0; i < 32; ++i) {
+            ctx[k].rk_enc[i] = rk[i][k];
+            ctx[k].rk_dec[31 - i] = rk[i][k];
+        }
+    }
+}
+
+/* ---------------- AVX-512BW + VAES：一次 16 个分组 ---------------- */
+
+#define SM4_AVX512 __attribute__((target("avx512f,avx512bw,vaes")))
+
+SM4_AVX512 inline __m512i bcast512(const uint8_t t[16]) {
+    return _mm512_broadcast_i32x4(_mm_load_si128(reinterpret_cast<const __m128i*>(t)));
+}
+
+struct ConstAVX512 {
+    __m512i pre_lo, pre_hi, post_lo, post_hi, inv_sr, mask4, rol8, rol16, rol24;
+
+    SM4_AVX512 ConstAVX512()
+        : pre_lo(bcast512(PRE_LO)), pre_hi(bcast512(PRE_HI)),
+          post_lo(bcast512(POST_LO)), post_hi(bcast512(POST_HI)),
+          inv_sr(bcast512(INV_SHIFT_ROWS)), mask4(_mm512_set1_epi8(0x0F)),
+          rol8(bcast512(ROL8)), rol16(bcast512(ROL16)), rol24(bcast512(ROL24)) {}
+};
+
+SM4_AVX512 inline __m512i affine512(__m512i x, __m512i lo_t, __m512i hi_t, __m512i mask4) {
+    __m512i lo = _mm512_and_si512(x, mask4);
+    __m512i hi = _mm512_and_si512(_mm512_srli_epi16(x, 4), mask4);
+    return _mm512_xor_si512(_mm512_shuffle_epi8(lo_t, lo), _mm512_shuffle_epi8(hi_t, hi));
+}
+
+SM4_AVX512 inline __m512i t512(__m512i x, const ConstAVX512& c) {
+    x = affine512(x, c.pre_lo, c.pre_hi, c.mask4);
+    x = _mm512_shuffle_epi8(x, c.inv_sr);
+    x = _mm512_aesenclast_epi128(x, _mm512_setzero_si512());
+    __m512i b = affine512(x, c.post_lo, c.post_hi, c.mask4);
+    __m512i t = _mm512_xor_si512(b, _mm512_xor_si512(_mm512_shuffle_epi8(b, c.rol8), _mm512_shuffle_epi8(b, c.rol16)));
+    return _mm512_xor_si512(_mm512_xor_si512(b, _mm512_shuffle_epi8(b, c.rol24)), _mm512_rol_epi32(t, 2));
+}
+
+SM4_AVX512 inline void transpose512(__m512i& x0, __m512i& x1, __m512i& x2, __m512i& x3) {
+    __m512i t0 = _mm512_unpacklo_epi32(x0, x1);
+    __m512i t1 = _mm512_unpackhi_epi32(x0, x1);
+    __m512i t2 = _mm512_unpacklo_epi32(x2, x3);
+    __m512i t3 = _mm512_unpackhi_epi32(x2, x3);
+    x0 = _mm512_unpacklo_epi64(t0, t2);
+    x1 = _mm512_unpackhi_epi64(t0, t2);
+    x2 = _mm512_unpacklo_epi64(t1, t3);
+    x3 = _mm512_unpackhi_epi64(t1, t3);
+}
+
+SM4_AVX512 void crypt16(const uint32_t rk[32], const uint8_t* in, uint8_t* out, const ConstAVX512& c) {
+    const __m512i bswap = bcast512(BSWAP32);
+    __m512i x0 = _mm512_shuffle_epi8(_mm512_loadu_si512(in), bswap);
+    __m512i x1 = _mm512_shuffle_epi8(_mm512_loadu_si512(in + 64), bswap);
+    __m512i x2 = _mm512_shuffle_epi8(_mm512_loadu_si512(in + 128), bswap);
+    __m512i x3 = _mm512_shuffle_epi8(_mm512_loadu_si512(in + 192), bswap);
+    transpose512(x0, x1, x2, x3);
+
+    for (int i = 0; i < 32; i += 4) {
+        x0 = _mm512_xor_si512(x0, t512(_mm512_xor_si512(_mm512_ternarylogic_epi32(x1, x2, x3, 0x96), _mm512_set1_epi32(int(rk[i]))), c));
+        x1 = _mm512_xor_si512(x1, t512(_mm512_xor_si512(_mm512_ternarylogic_epi32(x2, x3, x0, 0x96), _mm512_set1_epi32(int(rk[i + 1]))), c));
+        x2 = _mm512_xor_si512(x2, t512(_mm512_xor_si512(_mm512_ternarylogic_epi32(x3, x0, x1, 0x96), _mm512_set1_epi32(int(rk[i + 2]))), c));
+        x3 = _mm512_xor_si512(x3, t512(_mm512_xor_si512(_mm512_ternarylogic_epi32(x0, x1, x2, 0x96), _mm512_set1_epi32(int(rk[i + 3]))), c));
+    }
+
+    transpose512(x3, x2, x1, x0);
+    _mm512_storeu_si512(out, _mm512_shuffle_epi8(x3, bswap));
+    _mm512_storeu_si512(out + 64, _mm512_shuffle_epi8(x2, bswap));
+    _mm512_storeu_si512(out + 128, _mm512_shuffle_epi8(x1, bswap));
+    _mm512_storeu_si512(out + 192, _mm512_shuffle_epi8(x0, bswap));
+}
+
+SM4_AVX512 void keyExpand16(const uint8_t* keys, SM4Context* ctx, const ConstAVX512& c) {
+    alignas(64) uint32_t w[4][16];
+    for (int k = 0; k < 16; ++k) {
+        for (int j = 0; j < 4; ++j) {
+            w[j][k] = SM4::jointBytes(keys + 16 * k + 4 * j) ^ SM4::FK[j];
+        }
+    }
+    __m512i x0 = _mm512_load_si512(w[0]);
+    __m512i x1 = _mm512_load_si512(w[1]);
+    __m512i x2 = _mm512_load_si512(w[2]);
+    __m512i x3 = _mm512_load_si512(w[3]);
+
+    alignas(64) uint32_t rk[32][16];
+    for (int i = 0; i < 32; ++i) {
+        __m512i x = _mm512_xor_si512(_mm512_ternarylogic_epi32(x1, x2, x3, 0x96), _mm512_set1_epi32(int(SM4::CK[i])));
+        x = affine512(x, c.pre_lo, c.pre_hi, c.mask4);
+        x = _mm512_shuffle_epi8(x, c.inv_sr);
+        x = _mm512_aesenclast_epi128(x, _mm512_setzero_si512());
+        __m512i b = affine512(x, c.post_lo, c.post_hi, c.mask4);
+        __m512i t = _mm512_xor_si512(x0, _mm512_ternarylogic_epi32(b, _mm512_rol_epi32(b, 13), _mm512_rol_epi32(b, 23), 0x96));
+        _mm512_store_si512(rk[i], t);
+        x0 = x1;
+        x1 = x2;
+        x2 = x3;
+        x3 = t;
+    }
+    for (int k = 0; k < 16; ++k) {
+        for (int i = 0; i < 32; ++i) {
+            ctx[k].rk_enc[i] = rk[i][k];
+            ctx[k].rk_dec[31 - i] = rk[i][k];
+        }
+    }
+}
+
+/* ---------------- GFNI：仿射变换与求逆合并为两条指令 ---------------- */
+
+/*
+ * GF2P8AFFINEQB 计算 M·x + c，GF2P8AFFINEINVQB 计算 M·x^-1 + c（在 AES 的域中求逆），
+ * 因此 S_sm4(x) = POST · inv(PRE · x + 0x3E) + 0xD3，无需半字节查表，也无需 AESENCLAST 与逆 ShiftRows
+ */
+constexpr long long GFNI_PRE = 0x4C287DB91A22505DLL;
+constexpr long long GFNI_POST = static_cast<long long>(0xF3AB34A974A6B589ULL);
+constexpr int GFNI_PRE_C = 0x3E;
+constexpr int GFNI_POST_C = 0xD3;
+
+#define SM4_SSE_GFNI __attribute__((target("ssse3,gfni")))
+
+SM4_SSE_GFNI inline __m128i t128gfni(__m128i x, const ConstSSE& c) {
+    x = _mm_gf2p8affine_epi64_epi8(x, _mm_set1_epi64x(GFNI_PRE), GFNI_PRE_C);
+    return lSSE(_mm_gf2p8affineinv_epi64_epi8(x, _mm_set1_epi64x(GFNI_POST), GFNI_POST_C), c);
+}
+
+SM4_SSE_GFNI void crypt1gfni(const uint32_t rk[32], const uint8_t* in, uint8_t* out, const ConstSSE& c) {
+    __m128i x0 = _mm_set1_epi32(int(SM4::jointBytes(in)));
+    __m128i x1 = _mm_set1_epi32(int(SM4::jointBytes(in + 4)));
+    __m128i x2 = _mm_set1_epi32(int(SM4::jointBytes(in + 8)));
+    __m128i x3 = _mm_set1_epi32(int(SM4::jointBytes(in + 12)));
+    for (int i = 0; i < 32; i += 4) {
+        x0 = _mm_xor_si128(x0, t128gfni(roundInput(x1, x2, x3, rk[i]), c));
+        x1 = _mm_xor_si128(x1, t128gfni(roundInput(x2, x3, x0, rk[i + 1]), c));
+        x2 = _mm_xor_si128(x2, t128gfni(roundInput(x3, x0, x1, rk[i + 2]), c));
+        x3 = _mm_xor_si128(x3, t128gfni(roundInput(x0, x1, x2, rk[i + 3]), c));
+    }
+    storeSerial(x0, x1, x2, x3, out);
+}
+
+#define SM4_AVX2_GFNI __attribute__((target("avx2,aes,gfni")))
+
+SM4_AVX2_GFNI inline __m256i t256gfni(__m256i x, const ConstAVX2& c) {
+    x = _mm256_gf2p8affine_epi64_epi8(x, _mm256_set1_epi64x(GFNI_PRE), GFNI_PRE_C);
+    __m256i b = _mm256_gf2p8affineinv_epi64_epi8(x, _mm256_set1_epi64x(GFNI_POST), GFNI_POST_C);
+    __m256i t = _mm256_xor_si256(b, _mm256_xor_si256(_mm256_shuffle_epi8(b, c.rol8), _mm256_shuffle_epi8(b, c.rol16)));
+    return _mm256_xor_si256(_mm256_xor_si256(b, _mm256_shuffle_epi8(b, c.rol24)), rol32AVX2(t, 2));
+}
+
+SM4_AVX2_GFNI void crypt8gfni(const uint32_t rk[32], const uint8_t* in, uint8_t* out, const ConstAVX2& c) {
+    const __m256i bswap = bcast128(BSWAP32);
+    __m256i x0 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in)), bswap);
+    __m256i x1 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 32)), bswap);
+    __m256i x2 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 64)), bswap);
+    __m256i x3 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 96)), bswap);
+    transposeAVX2(x0, x1, x2, x3);
+
+    for (int i = 0; i < 32; i += 4) {
+        x0 = _mm256_xor_si256(x0, t256gfni(_mm256_xor_si256(_mm256_xor_si256(x1, x2), _mm256_xor_si256(x3, _mm256_set1_epi32(int(rk[i])))), c));
+        x1 = _mm256_xor_si256(x1, t256gfni(_mm256_xor_si256(_mm256_xor_si256(x2, x3), _mm256_xor_si256(x0, _mm256_set1_epi32(int(rk[i + 1])))), c));
+        x2 = _mm256_xor_si256(x2, t256gfni(_mm256_xor_si256(_mm256_xor_si256(x3, x0), _mm256_xor_si256(x1, _mm256_set1_epi32(int(rk[i + 2])))), c));
+        x3 = _mm256_xor_si256(x3, t256gfni(_mm256_xor_si256(_mm256_xor_si256(x0, x1), _mm256_xor_si256(x2, _mm256_set1_epi32(int(rk[i + 3])))), c));
+    }
+
+    transposeAVX2(x3, x2, x1, x0);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_shuffle_epi8(x3, bswap));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), _mm256_shuffle_epi8(x2, bswap));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 64), _mm256_shuffle_epi8(x1, bswap));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 96), _mm256_shuffle_epi8(x0, bswap));
+}
+
+#define SM4_AVX512_GFNI __attribute__((target("avx512f,avx512bw,vaes,gfni")))
+
+SM4_AVX512_GFNI inline __m512i t512gfni(__m512i x, const ConstAVX512& c) {
+    x = _mm512_gf2p8affine_epi64_epi8(x, _mm512_set1_epi64(GFNI_PRE), GFNI_PRE_C);
+    __m512i b = _mm512_gf2p8affineinv_epi64_epi8(x, _mm512_set1_epi64(GFNI_POST), GFNI_POST_C);
+    __m512i t = _mm512_xor_si512(b, _mm512_xor_si512(_mm512_shuffle_epi8(b, c.rol8), _mm512_shuffle_epi8(b, c.rol16)));
+    return _mm512_xor_si512(_mm512_xor_si512(b, _mm512_shuffle_epi8(b, c.rol24)), _mm512_rol_epi32(t, 2));
+}
+
+SM4_AVX512_GFNI void crypt16gfni(const uint32_t rk[32], const uint8_t* in, uint8_t* out, const ConstAVX512& c) {
+    const __m512i bswap = bcast512(BSWAP32);
+    __m512i x0 = _mm512_shuffle_epi8(_mm512_loadu_si512(in), bswap);
+    __m512i x1 = _mm512_shuffle_epi8(_mm512_loadu_si512(in + 64), bswap);
+    __m512i x2 = _mm512_shuffle_epi8(_mm512_loadu_si512(in + 128), bswap);
+    __m512i x3 = _mm512_shuffle_epi8(_mm512_loadu_si512(in + 192), bswap);
+    transpose512(x0, x1, x2, x3);
+
+    for (int i = 0; i < 32; i += 4) {
+        x0 = _mm512_xor_si512(x0, t512gfni(_mm512_xor_si512(_mm512_ternarylogic_epi32(x1, x2, x3, 0x96), _mm512_set1_epi32(int(rk[i]))), c));
+        x1 = _mm512_xor_si512(x1, t512gfni(_mm512_xor_si512(_mm512_ternarylogic_epi32(x2, x3, x0, 0x96), _mm512_set1_epi32(int(rk[i + 1]))), c));
+        x2 = _mm512_xor_si512(x2, t512gfni(_mm512_xor_si512(_mm512_ternarylogic_epi32(x3, x0, x1, 0x96), _mm512_set1_epi32(int(rk[i + 2]))), c));
+        x3 = _mm512_xor_si512(x3, t512gfni(_mm512_xor_si512(_mm512_ternarylogic_epi32(x0, x1, x2, 0x96), _mm512_set1_epi32(int(rk[i + 3]))), c));
+    }
+
+    transpose512(x3, x2, x1, x0);
+    _mm512_storeu_si512(out, _mm512_shuffle_epi8(x3, bswap));
+    _mm512_storeu_si512(out + 64, _mm512_shuffle_epi8(x2, bswap));
+    _mm512_storeu_si512(out + 128, _mm512_shuffle_epi8(x1, bswap));
+    _mm512_storeu_si512(out + 192, _mm512_shuffle_epi8(x0, bswap));
+}
+
+/* 整组走向量内核，尾部补齐到临时缓冲区后同样走向量内核，不引入查表路径 */
+SM4_SSE void cryptSSE(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    const ConstSSE c;
+    for (; nblocks >= 4; nblocks -= 4, in += 64, out += 64) {
+        crypt4(rk, in, out, c);
+    }
+    if (nblocks) {
+        uint8_t buf[64] = {0};
+        std::memcpy(buf, in, nblocks * SM4::BLOCK_SIZE);
+        crypt4(rk, buf, buf, c);
+        std::memcpy(out, buf, nblocks * SM4::BLOCK_SIZE);
+    }
+}
+
+SM4_SSE void serialSSE(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    const ConstSSE c;
+    for (; nblocks; --nblocks, in += 16, out += 16) {
+        crypt1(rk, in, out, c);
+    }
+}
+
+SM4_SSE_GFNI void serialGFNI(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    const ConstSSE c;
+    for (; nblocks; --nblocks, in += 16, out += 16) {
+        crypt1gfni(rk, in, out, c);
+    }
+}
+
+SM4_AVX2 void cryptAVX2(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    const ConstAVX2 c;
+    for (; nblocks >= 8; nblocks -= 8, in += 128, out += 128) {
+        crypt8(rk, in, out, c);
+    }
+    if (nblocks) {
+        uint8_t buf[128] = {0};
+        std::memcpy(buf, in, nblocks * SM4::BLOCK_SIZE);
+        crypt8(rk, buf, buf, c);
+        std::memcpy(out, buf, nblocks * SM4::BLOCK_SIZE);
+    }
+}
+
+SM4_AVX512 void cryptAVX512(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    const ConstAVX512 c;
+    for (; nblocks >= 16; nblocks -= 16, in += 256, out += 256) {
+        crypt16(rk, in, out, c);
+    }
+    if (nblocks) {
+        uint8_t buf[256] = {0};
+        std::memcpy(buf, in, nblocks * SM4::BLOCK_SIZE);
+        crypt16(rk, buf, buf, c);
+        std::memcpy(out, buf, nblocks * SM4::BLOCK_SIZE);
+    }
+}
+
+SM4_AVX2_GFNI void cryptAVX2GFNI(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    const ConstAVX2 c;
+    for (; nblocks >= 8; nblocks -= 8, in += 128, out += 128) {
+        crypt8gfni(rk, in, out, c);
+    }
+    if (nblocks) {
+        uint8_t buf[128] = {0};
+        std::memcpy(buf, in, nblocks * SM4::BLOCK_SIZE);
+        crypt8gfni(rk, buf, buf, c);
+        std::memcpy(out, buf, nblocks * SM4::BLOCK_SIZE);
+    }
+}
+
+SM4_AVX512_GFNI void cryptAVX512GFNI(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    const ConstAVX512 c;
+    for (; nblocks >= 16; nblocks -= 16, in += 256, out += 256) {
+        crypt16gfni(rk, in, out, c);
+    }
+    if (nblocks) {
+        uint8_t buf[256] = {0};
+        std::memcpy(buf, in, nblocks * SM4::BLOCK_SIZE);
+        crypt16gfni(rk, buf, buf, c);
+        std::memcpy(out, buf, nblocks * SM4::BLOCK_SIZE);
+    }
+}
+
+/* 不足一组的密钥补零到临时缓冲区，只拷回有效的上下文 */
+SM4_AVX2 void keysAVX2(const uint8_t* keys, SM4Context* ctx, size_t nkeys) {
+    const ConstAVX2 c;
+    for (; nkeys >= 8; nkeys -= 8, keys += 128, ctx += 8) {
+        keyExpand8(keys, ctx, c);
+    }
+    if (nkeys) {
+        uint8_t buf[128] = {0};
+        SM4Context tmp[8];
+        std::memcpy(buf, keys, nkeys * 16);
+        keyExpand8(buf, tmp, c);
+        std::memcpy(ctx, tmp, nkeys * sizeof(SM4Context));
+    }
+}
+
+SM4_AVX512 void keysAVX512(const uint8_t* keys, SM4Context* ctx, size_t nkeys) {
+    const ConstAVX512 c;
+    for (; nkeys >= 16; nkeys -= 16, keys += 256, ctx += 16) {
+        keyExpand16(keys, ctx, c);
+    }
+    if (nkeys) {
+        uint8_t buf[256] = {0};
+        SM4Context tmp[16];
+        std::memcpy(buf, keys, nkeys * 16);
+        keyExpand16(buf, tmp, c);
+        std::memcpy(ctx, tmp, nkeys * sizeof(SM4Context));
+    }
+}
+
+} // namespace
+
+bool SM4_SIMD::hasSSE() {
+    static const bool ok = __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("aes");
+    return ok;
+}
+
+bool SM4_SIMD::hasAVX2() {
+    static const bool ok = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("aes");
+    return ok;
+}
+
+bool SM4_SIMD::hasAVX512() {
+    static const bool ok = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+                           __builtin_cpu_supports("vaes");
+    return ok;
+}
+
+bool SM4_SIMD::hasAVX2GFNI() {
+    static const bool ok = hasAVX2() && __builtin_cpu_supports("gfni");
+    return ok;
+}
+
+bool SM4_SIMD::hasAVX512GFNI() {
+    static const bool ok = hasAVX512() && __builtin_cpu_supports("gfni");
+    return ok;
+}
+
+void SM4_SIMD::cryptBlocksSSE(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    cryptSSE(rk, in, out, nblocks);
+}
+
+void SM4_SIMD::cryptBlocksAVX2(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    cryptAVX2(rk, in, out, nblocks);
+}
+
+void SM4_SIMD::cryptBlocksAVX2GFNI(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    cryptAVX2GFNI(rk, in, out, nblocks);
+}
+
+void SM4_SIMD::cryptBlocksAVX512(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    cryptAVX512(rk, in, out, nblocks);
+}
+
+void SM4_SIMD::cryptBlocksAVX512GFNI(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    cryptAVX512GFNI(rk, in, out, nblocks);
+}
+
+void SM4_SIMD::cryptSerialSSE(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    serialSSE(rk, in, out, nblocks);
+}
+
+void SM4_SIMD::cryptSerialGFNI(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    serialGFNI(rk, in, out, nblocks);
+}
+
+#else // !SM4_SIMD_X86
+
+bool SM4_SIMD::hasSSE() { return false; }
+bool SM4_SIMD::hasAVX2() { return false; }
+bool SM4_SIMD::hasAVX2GFNI() { return false; }
+bool SM4_SIMD::hasAVX512() { return false; }
+bool SM4_SIMD::hasAVX512GFNI() { return false; }
+
+// 没有向量指令时回退到 T 表内核，保持接口可用
+void SM4_SIMD::cryptBlocksSSE(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    OptimizedSM4::cryptBlocks(rk, in, out, nblocks);
+}
+
+void SM4_SIMD::cryptBlocksAVX2(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    OptimizedSM4::cryptBlocks(rk, in, out, nblocks);
+}
+
+void SM4_SIMD::cryptBlocksAVX2GFNI(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    OptimizedSM4::cryptBlocks(rk, in, out, nblocks);
+}
+
+void SM4_SIMD::cryptBlocksAVX512(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    OptimizedSM4::cryptBlocks(rk, in, out, nblocks);
+}
+
+void SM4_SIMD::cryptBlocksAVX512GFNI(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    OptimizedSM4::cryptBlocks(rk, in, out, nblocks);
+}
+
+void SM4_SIMD::cryptSerialSSE(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    OptimizedSM4::cryptBlocks(rk, in, out, nblocks);
+}
+
+void SM4_SIMD::cryptSerialGFNI(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    OptimizedSM4::cryptBlocks(rk, in, out, nblocks);
+}
+
+#endif // SM4_SIMD_X86
+
+void SM4_SIMD::cryptBlocks(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    if (hasAVX512GFNI()) {
+        cryptBlocksAVX512GFNI(rk, in, out, nblocks);
+    } else if (hasAVX512()) {
+        cryptBlocksAVX512(rk, in, out, nblocks);
+    } else if (hasAVX2GFNI()) {
+        cryptBlocksAVX2GFNI(rk, in, out, nblocks);
+    } else if (hasAVX2()) {
+        cryptBlocksAVX2(rk, in, out, nblocks);
+    } else if (hasSSE()) {
+        cryptBlocksSSE(rk, in, out, nblocks);
+    } else {
+        OptimizedSM4::cryptBlocks(rk, in, out, nblocks);
+    }
+}
+
+void SM4_SIMD::keyGenerateBatch(const uint8_t* keys, SM4Context* ctx, size_t nkeys) {
+#ifdef SM4_SIMD_X86
+    if (hasAVX512()) {
+        keysAVX512(keys, ctx, nkeys);
+        return;
+    }
+    if (hasAVX2()) {
+        keysAVX2(keys, ctx, nkeys);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < nkeys; ++i) {
+        SM4::initContext(keys + 16 * i, ctx[i]);
+    }
+}
+
+const char* SM4_SIMD::backendName() {
+    if (hasAVX512GFNI()) return "avx512-gfni";
+    if (hasAVX512()) return "avx512";
+    if (hasAVX2GFNI()) return "avx2-gfni";
+    if (hasAVX2()) return "avx2";
+    return hasSSE() ? "sse" : "ttable";
+}
+
+SM4_SIMD::SM4_SIMD(const uint8_t key[16]) {
+    SM4::initContext(key, ctx);
+}
+
+SM4_SIMD::SM4_SIMD(const std::vector<unsigned char>& key)
+    : SM4_SIMD(key.data()) {}
+
+SM4_SIMD::SM4_SIMD(const SM4Context& ctx)
+    : ctx(ctx) {}
+
+void SM4_SIMD::encrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const {
+    cryptBlocks(ctx.rk_enc, in, out, nblocks);
+}
+
+void SM4_SIMD::decrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const {
+    cryptBlocks(ctx.rk_dec, in, out, nblocks);
+}
+
+std::vector<unsigned char> SM4_SIMD::encrypt(const std::vector<unsigned char>& plaintext) const {
+    std::vector<unsigned char> output(SM4::BLOCK_SIZE);
+    encrypt_blocks(plaintext.data(), output.data(), 1);
+    return output;
+}
+
+std::vector<unsigned char> SM4_SIMD::decrypt(const std::vector<unsigned char>& ciphertext) const {
+    std::vector<unsigned char> output(SM4::BLOCK_SIZE);
+    decrypt_blocks(ciphertext.data(), output.data(), 1);
+    return output;
 }
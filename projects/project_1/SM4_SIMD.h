@@ -0,0 +1,78 @@
+#ifndef SM4_SIMD_H
+#define SM4_SIMD_H
+
+#include "sm4.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * SM4_SIMD
+ * 多分组数据并行的 SM4：把 8（AVX2）或 16（AVX-512）个分组转置到向量的各个 32 位通道，
+ * 每个通道独立完成一个分组的 32 轮迭代。S 盒不查内存表，而是利用
+ * SM4 S 盒与 AES S 盒的仿射等价关系：
+ *     S_sm4(x) = A2 · S_aes(A1 · x + c1) + c2
+ * 其中仿射变换 A1/A2 按高低半字节拆分后用 PSHUFB 实现，S_aes 由 AESENCLAST 完成，
+ * 全程没有数据相关的访存，天然恒定时间。
+ *
+ * 支持 GFNI 时，仿射变换与求逆直接用 GF2P8AFFINEQB / GF2P8AFFINEINVQB 两条指令完成。
+ *
+ * 运行时检测 CPU，按 AVX-512+GFNI、AVX-512BW+VAES（16 路）、AVX2+GFNI、AVX2+AES-NI（8 路）、
+ * SSSE3+AES-NI（4 路）的顺序选择，都不支持时回退到 T 表实现 OptimizedSM4。
+ */
+class SM4_SIMD {
+public:
+    explicit SM4_SIMD(const std::vector<unsigned char>& key);
+    explicit SM4_SIMD(const uint8_t key[16]);
+    explicit SM4_SIMD(const SM4Context& ctx);
+
+    // 单分组接口，与 SM4 相同
+    std::vector<unsigned char> encrypt(const std::vector<unsigned char>& plaintext) const;
+    std::vector<unsigned char> decrypt(const std::vector<unsigned char>& ciphertext) const;
+
+    // 批量 ECB 接口，与 SM4::encrypt_blocks / decrypt_blocks 相同
+    void encrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const;
+    void decrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const;
+
+    /*
+     * 批量分组核心：按 rk[0..31] 的顺序执行 32 轮，自动选择当前 CPU 支持的最宽内核
+     * 不足一组的尾部分组补齐到临时缓冲区后同样走向量内核
+     */
+    static void cryptBlocks(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks);
+
+    // 指定宽度的内核，调用前需确认 CPU 支持；非 x86 平台上回退到 T 表内核
+    static void cryptBlocksSSE(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks);
+    static void cryptBlocksAVX2(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks);
+    static void cryptBlocksAVX2GFNI(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks);
+    static void cryptBlocksAVX512(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks);
+    static void cryptBlocksAVX512GFNI(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks);
+
+    /*
+     * 单分组内核：一次只算一个分组，状态留在 XMM 寄存器里，不转置、不补齐
+     * 供 CBC/CFB 加密、OFB 这类串行链使用，同样没有数据相关的访存；多分组时逐个处理
+     * SSE 版本需要 SSSE3 + AES-NI，GFNI 版本需要 SSSE3 + GFNI；非 x86 平台上回退到 T 表内核
+     */
+    static void cryptSerialSSE(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks);
+    static void cryptSerialGFNI(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks);
+
+    /*
+     * 批量密钥拓展：展开连续存放的 nkeys 个 16 字节密钥，结果写入 ctx[0 .. nkeys-1]
+     * 每个向量通道独立完成一个密钥的 32 轮拓展，8（AVX2）或 16（AVX-512）个密钥一组
+     */
+    static void keyGenerateBatch(const uint8_t* keys, SM4Context* ctx, size_t nkeys);
+
+    // CPU 特性检测
+    static bool hasSSE();        // SSSE3 + AES-NI
+    static bool hasAVX2();       // AVX2 + AES-NI
+    static bool hasAVX2GFNI();   // AVX2 + AES-NI + GFNI
+    static bool hasAVX512();     // AVX-512F/BW + VAES
+    static bool hasAVX512GFNI(); // AVX-512F/BW + VAES + GFNI
+
+    // 当前选用的内核名称（"avx512-gfni" / "avx512" / "avx2-gfni" / "avx2" / "sse" / "ttable"）
+    static const char* backendName();
+
+private:
+    SM4Context ctx; // 加密与逆序的解密轮密钥
+};
+
+#endif // SM4_SIMD_H
@@ -1,67 +1,94 @@
-#include <iostream>
-#include <vector>
-#include <numeric>
-
-class OptimizedSM4 {
-private:
-    std::vector<unsigned int> key_r;
-    static unsigned int T_TABLE[256];
-
-    // S-box and other constants remain the same
-    // ... (Your original SBOX, FK, CK arrays here)
-
-    // Function to calculate and build the T-table
-    static void buildTTable() {
-        if (T_TABLE[0] == 0) { // Check if the table is already built
-            for (int i = 0; i < 256; ++i) {
-                unsigned int sbox_out = SBOX[i];
-                unsigned int temp = sbox_out ^ shift(sbox_out, 2) ^ shift(sbox_out, 10) ^ shift(sbox_out, 18) ^ shift(sbox_out, 24);
-                T_TABLE[i] = temp;
-            }
+#include "SM4_T_Table.h"
+#include "sm4.h"
+
+namespace {
+
+/*
+ * T_TABLE[k][b] = L(S(b) << (24 - 8k))，k 为字节在 32 位字中的位置（0 为最高字节）
+ * 由于 L 是循环移位的异或，T_TABLE[k] 就是 T_TABLE[0] 循环右移 8k 位
+ */
+struct TTable {
+    uint32_t t[4][256];
+};
+
+constexpr uint32_t linearL(uint32_t b) {
+    return b ^ SM4::shift(b, 2) ^ SM4::shift(b, 10) ^ SM4::shift(b, 18) ^ SM4::shift(b, 24);
+}
+
+constexpr TTable buildTTable() {
+    TTable table{};
+    for (int i = 0; i < 256; ++i) {
+        uint32_t sbox_out = SM4::SBOX[i];
+        for (int k = 0; k < 4; ++k) {
+            table.t[k][i] = linearL(sbox_out << (24 - 8 * k));
         }
     }
+    return table;
+}
 
-    // New optimized round function
-    unsigned int optimizedRound(unsigned int x0, unsigned int x1, unsigned int x2, unsigned int x3, unsigned int rk) {
-        // T-table replaces S-box and L-box in one go
-        unsigned int temp = (T_TABLE[x1 >> 24] ^ T_TABLE[(x1 >> 16) & 0xFF] ^ T_TABLE[(x1 >> 8) & 0xFF] ^ T_TABLE[x1 & 0xFF]) ^ rk;
-        return x0 ^ temp;
-    }
+// 编译期生成，存放在只读数据段：无运行时初始化，也就不存在初始化竞争
+constexpr TTable T_TABLE = buildTTable();
 
-    /* 加解密主模块 (Optimized) */
-    std::vector<unsigned char> sm4Main(const std::vector<unsigned char>& input, int mod) {
-        std::vector<unsigned int> text(4);
-        for (int i = 0; i < 4; ++i) {
-            text[i] = jointBytes(input[4 * i], input[4 * i + 1], input[4 * i + 2], input[4 * i + 3]);
-        }
+static_assert(T_TABLE.t[3][0x00] == linearL(0xD6), "T_TABLE[3][0] 应为 L(S(0))");
+static_assert(T_TABLE.t[0][0xFF] == SM4::shift(T_TABLE.t[3][0xFF], 24), "T_TABLE 各表应互为循环移位");
 
-        for (int i = 0; i < 32; ++i) {
-            int index = (mod == 0) ? i : (31 - i);
-            unsigned int temp = optimizedRound(text[0], text[1], text[2], text[3], key_r[index]);
-            text[0] = text[1];
-            text[1] = text[2];
-            text[2] = text[3];
-            text[3] = temp;
-        }
+/* T 变换：S 盒 + 线性变换 L 合并为 4 次查表 */
+inline uint32_t tTransform(uint32_t x) {
+    return T_TABLE.t[0][x >> 24] ^ T_TABLE.t[1][(x >> 16) & 0xFF] ^
+           T_TABLE.t[2][(x >> 8) & 0xFF] ^ T_TABLE.t[3][x & 0xFF];
+}
+
+} // namespace
 
-        // Final reverse order
-        std::vector<unsigned char> output(16);
-        for (int i = 0; i < 4; ++i) {
-            std::vector<unsigned char> split_bytes = splitInt(text[3 - i]);
-            for (int j = 0; j < 4; ++j) {
-                output[4 * i + j] = split_bytes[j];
-            }
+void OptimizedSM4::cryptBlocks(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    for (size_t n = 0; n < nblocks; ++n, in += SM4::BLOCK_SIZE, out += SM4::BLOCK_SIZE) {
+        uint32_t x0 = SM4::jointBytes(in);
+        uint32_t x1 = SM4::jointBytes(in + 4);
+        uint32_t x2 = SM4::jointBytes(in + 8);
+        uint32_t x3 = SM4::jointBytes(in + 12);
+
+        // 每次迭代完成 4 轮，省去状态字的轮换
+        for (int i = 0; i < 32; i += 4) {
+            x0 ^= tTransform(x1 ^ x2 ^ x3 ^ rk[i]);
+            x1 ^= tTransform(x2 ^ x3 ^ x0 ^ rk[i + 1]);
+            x2 ^= tTransform(x3 ^ x0 ^ x1 ^ rk[i + 2]);
+            x3 ^= tTransform(x0 ^ x1 ^ x2 ^ rk[i + 3]);
         }
-        return output;
-    }
 
-public:
-    OptimizedSM4(const std::vector<unsigned char>& key) {
-        buildTTable(); // Ensure T-table is built
-        this->key_r = keyGenerate(key);
+        // 反序变换 R
+        SM4::splitInt(x3, out);
+        SM4::splitInt(x2, out + 4);
+        SM4::splitInt(x1, out + 8);
+        SM4::splitInt(x0, out + 12);
     }
-    // Encrypt and Decrypt methods remain the same
-    // ...
-};
+}
+
+OptimizedSM4::OptimizedSM4(const uint8_t key[16]) {
+    SM4::initContext(key, ctx);
+}
+
+OptimizedSM4::OptimizedSM4(const std::vector<unsigned char>& key)
+    : OptimizedSM4(key.data()) {}
+
+OptimizedSM4::OptimizedSM4(const SM4Context& ctx)
+    : ctx(ctx) {}
+
+void OptimizedSM4::encrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const {
+    cryptBlocks(ctx.rk_enc, in, out, nblocks);
+}
+
+void OptimizedSM4::decrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const {
+    cryptBlocks(ctx.rk_dec, in, out, nblocks);
+}
+
+std::vector<unsigned char> OptimizedSM4::encrypt(const std::vector<unsigned char>& plaintext) const {
+    std::vector<unsigned char> output(SM4::BLOCK_SIZE);
+    encrypt_blocks(plaintext.data(), output.data(), 1);
+    return output;
+}
 
-unsigned int OptimizedSM4::T_TABLE[256] = {0}; // Static initialization
+std::vector<unsigned char> OptimizedSM4::decrypt(const std::vector<unsigned char>& ciphertext) const {
+    std::vector<unsigned char> output(SM4::BLOCK_SIZE);
+    decrypt_blocks(ciphertext.data(), output.data(), 1);
+    return output;
+}
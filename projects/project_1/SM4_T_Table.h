@@ -0,0 +1,38 @@
+#ifndef SM4_T_TABLE_H
+#define SM4_T_TABLE_H
+
+#include "sm4.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * OptimizedSM4
+ * T 表实现：把 S 盒与线性变换 L 合并为 4 张按字节位置旋转好的 256 项表，
+ * 每轮只需 4 次查表和若干次异或。表在编译期由 SM4::SBOX 生成。
+ */
+class OptimizedSM4 {
+public:
+    explicit OptimizedSM4(const std::vector<unsigned char>& key);
+    explicit OptimizedSM4(const uint8_t key[16]);
+    explicit OptimizedSM4(const SM4Context& ctx);
+
+    // 单分组接口，与 SM4 相同
+    std::vector<unsigned char> encrypt(const std::vector<unsigned char>& plaintext) const;
+    std::vector<unsigned char> decrypt(const std::vector<unsigned char>& ciphertext) const;
+
+    // 批量 ECB 接口，与 SM4::encrypt_blocks / decrypt_blocks 相同
+    void encrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const;
+    void decrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const;
+
+    /*
+     * 批量分组核心：按 rk[0..31] 的顺序执行 32 轮
+     * 传入正序轮密钥即加密，传入逆序轮密钥即解密
+     */
+    static void cryptBlocks(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks);
+
+private:
+    SM4Context ctx; // 加密与逆序的解密轮密钥
+};
+
+#endif // SM4_T_TABLE_H
@@ -0,0 +1,122 @@
+#ifndef SM4_H
+#define SM4_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * 批量分组内核：按 rk[0..31] 的顺序执行 32 轮，处理 nblocks 个连续的 16 字节分组
+ * 传入正序轮密钥即加密，传入逆序轮密钥即解密；各实现的 cryptBlocks 均符合该签名
+ */
+typedef void (*SM4BlocksFn)(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks);
+
+/*
+ * 展开后的密钥上下文（POD，可直接拷贝、放进数组或缓存）
+ * rk_enc 为加密轮密钥 rk_0 ~ rk_31，rk_dec 为预先逆序的解密轮密钥，可直接传给 SM4BlocksFn
+ */
+struct SM4Context {
+    uint32_t rk_enc[32];
+    uint32_t rk_dec[32];
+};
+
+/*
+ * SM4 分组密码（GM/T 0002-2012）参考实现
+ * 分组长度与密钥长度均为 128 位，迭代 32 轮
+ */
+class SM4 {
+public:
+    static constexpr size_t BLOCK_SIZE = 16;
+
+    /*
+     * 初始化轮密钥
+     * @param key: 16 字节密钥
+     */
+    explicit SM4(const std::vector<unsigned char>& key);
+    explicit SM4(const uint8_t key[16]);
+
+    /* 直接使用已展开的密钥上下文（如来自 SM4KeyCache 或批量密钥拓展），省去密钥拓展 */
+    explicit SM4(const SM4Context& ctx);
+
+    /*
+     * 单分组加解密（兼容旧接口），内部转调批量接口
+     * @param plaintext / ciphertext: 16 字节输入
+     * @return 16 字节输出
+     */
+    std::vector<unsigned char> encrypt(const std::vector<unsigned char>& plaintext) const;
+    std::vector<unsigned char> decrypt(const std::vector<unsigned char>& ciphertext) const;
+
+    /*
+     * 批量 ECB 加解密：处理 nblocks 个连续的 16 字节分组，热路径无堆分配
+     * in 与 out 可以指向同一块内存（原地加解密）
+     */
+    void encrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const;
+    void decrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const;
+
+    /* 批量分组核心：按 rk[0..31] 的顺序执行 32 轮，符合 SM4BlocksFn 签名 */
+    static void cryptBlocks(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks);
+
+    /* 密钥拓展：由 16 字节密钥生成 32 个轮密钥 rk_0 ~ rk_31 */
+    static void keyGenerate(const uint8_t key[16], uint32_t key_r[32]);
+
+    /* 密钥拓展并生成逆序的解密轮密钥 */
+    static void initContext(const uint8_t key[16], SM4Context& ctx);
+
+    // 系统参数 FK 与固定参数 CK，批量密钥拓展（SM4_SIMD::keyGenerateBatch）同样使用
+    static const uint32_t FK[4];
+    static const uint32_t CK[32];
+
+    // S 盒（256 字节查找表），constexpr 以便 T 表等在编译期由它生成
+    static constexpr uint8_t SBOX[256] = {
+        0xD6, 0x90, 0xE9, 0xFE, 0xCC, 0xE1, 0x3D, 0xB7, 0x16, 0xB6, 0x14, 0xC2, 0x28, 0xFB, 0x2C, 0x05,
+        0x2B, 0x67, 0x9A, 0x76, 0x2A, 0xBE, 0x04, 0xC3, 0xAA, 0x44, 0x13, 0x26, 0x49, 0x86, 0x06, 0x99,
+        0x9C, 0x42, 0x50, 0xF4, 0x91, 0xEF, 0x98, 0x7A, 0x33, 0x54, 0x0B, 0x43, 0xED, 0xCF, 0xAC, 0x62,
+        0xE4, 0xB3, 0x1C, 0xA9, 0xC9, 0x08, 0xE8, 0x95, 0x80, 0xDF, 0x94, 0xFA, 0x75, 0x8F, 0x3F, 0xA6,
+        0x47, 0x07, 0xA7, 0xFC, 0xF3, 0x73, 0x17, 0xBA, 0x83, 0x59, 0x3C, 0x19, 0xE6, 0x85, 0x4F, 0xA8,
+        0x68, 0x6B, 0x81, 0xB2, 0x71, 0x64, 0xDA, 0x8B, 0xF8, 0xEB, 0x0F, 0x4B, 0x70, 0x56, 0x9D, 0x35,
+        0x1E, 0x24, 0x0E, 0x5E, 0x63, 0x58, 0xD1, 0xA2, 0x25, 0x22, 0x7C, 0x3B, 0x01, 0x21, 0x78, 0x87,
+        0xD4, 0x00, 0x46, 0x57, 0x9F, 0xD3, 0x27, 0x52, 0x4C, 0x36, 0x02, 0xE7, 0xA0, 0xC4, 0xC8, 0x9E,
+        0xEA, 0xBF, 0x8A, 0xD2, 0x40, 0xC7, 0x38, 0xB5, 0xA3, 0xF7, 0xF2, 0xCE, 0xF9, 0x61, 0x15, 0xA1,
+        0xE0, 0xAE, 0x5D, 0xA4, 0x9B, 0x34, 0x1A, 0x55, 0xAD, 0x93, 0x32, 0x30, 0xF5, 0x8C, 0xB1, 0xE3,
+        0x1D, 0xF6, 0xE2, 0x2E, 0x82, 0x66, 0xCA, 0x60, 0xC0, 0x29, 0x23, 0xAB, 0x0D, 0x53, 0x4E, 0x6F,
+        0xD5, 0xDB, 0x37, 0x45, 0xDE, 0xFD, 0x8E, 0x2F, 0x03, 0xFF, 0x6A, 0x72, 0x6D, 0x6C, 0x5B, 0x51,
+        0x8D, 0x1B, 0xAF, 0x92, 0xBB, 0xDD, 0xBC, 0x7F, 0x11, 0xD9, 0x5C, 0x41, 0x1F, 0x10, 0x5A, 0xD8,
+        0x0A, 0xC1, 0x31, 0x88, 0xA5, 0xCD, 0x7B, 0xBD, 0x2D, 0x74, 0xD0, 0x12, 0xB8, 0xE5, 0xB4, 0xB0,
+        0x89, 0x69, 0x97, 0x4A, 0x0C, 0x96, 0x77, 0x7E, 0x65, 0xB9, 0xF1, 0x09, 0xC5, 0x6E, 0xC6, 0x84,
+        0x18, 0xF0, 0x7D, 0xEC, 0x3A, 0xDC, 0x4D, 0x20, 0x79, 0xEE, 0x5F, 0x3E, 0xD7, 0xCB, 0x39, 0x48
+    };
+
+    /* 将 input 左移 n 位 (循环左移) */
+    static constexpr uint32_t shift(uint32_t input, int n) {
+        return (input << n) | (input >> (32 - n));
+    }
+
+    /* 将4个8比特数合并成32比特数（大端序） */
+    static inline uint32_t jointBytes(const uint8_t* p) {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+    }
+
+    /* 将32比特数拆分成4个8比特数（大端序） */
+    static inline void splitInt(uint32_t n, uint8_t* p) {
+        p[0] = uint8_t(n >> 24);
+        p[1] = uint8_t(n >> 16);
+        p[2] = uint8_t(n >> 8);
+        p[3] = uint8_t(n);
+    }
+
+    /* S盒变换：对 32 位字的 4 个字节分别查表 */
+    static inline uint32_t sBox(uint32_t box_input) {
+        return (uint32_t(SBOX[(box_input >> 24) & 0xFF]) << 24) |
+               (uint32_t(SBOX[(box_input >> 16) & 0xFF]) << 16) |
+               (uint32_t(SBOX[(box_input >> 8) & 0xFF]) << 8) |
+                uint32_t(SBOX[box_input & 0xFF]);
+    }
+
+private:
+    SM4Context ctx; // 加密与逆序的解密轮密钥
+
+    /* 加解密主模块：按 rk[0..31] 的顺序迭代，传入 rk_enc 加密、rk_dec 解密 */
+    static void sm4Main(const uint8_t input[16], uint8_t output[16], const uint32_t rk[32]);
+};
+
+#endif // SM4_H
@@ -0,0 +1,583 @@
+#include "sm4.h"
+#include "SM4_SIMD.h"
+#include "SM4_Bitslice.h"
+#include "sm4_ctr.h"
+#include "sm4_gcm.h"
+#include "sm4_modes.h"
+#include "sm4_xts.h"
+#include "sm4_key_cache.h"
+#include "sm4_engine.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define SM4_BENCH_TSC 1
+#endif
+
+/*
+ * SM4 基准测试套件：各后端 × 各模式 × 各消息长度 × 单/多线程，输出 JSON，便于跨版本对比回归
+ *
+ *   模式：ecb（加密）、ctr、cbc-enc、cbc-dec、cfb-enc、cfb-dec、ofb、
+ *         cbc-dec-sm4（对照：逐分组调用 SM4::decrypt 的 CBC 解密，与后端无关，只测一次）、
+ *         gcm（加密并生成标签，GHASH 按 SM4Engine 选择）、gcm-table（查表 GHASH）、
+ *         xts-512、xts-4096（按 512 / 4096 字节扇区加密）、
+ *         xts-mmap-512、xts-mmap-4096（在临时文件的内存映射上原地加密扇区，模拟磁盘镜像）
+ *   长度：16 B 起按 4 倍递增到 --max-size（默认 64 MiB）；XTS 跳过短于一个扇区的长度；
+ *         串行模式（cbc-enc、cfb-enc、ofb、cbc-dec-sm4）在位切片与参考实现上只测到 4 MiB，
+ *         更长的样本每个要数十秒到数分钟
+ *   线程：每个长度先测单线程；长度不小于 64 KiB 时再用 --threads 个线程（默认硬件并发数）
+ *         把缓冲区按分组（XTS 按扇区）均分成若干段各自处理。ECB/CTR/CBC 解密/CFB 解密/XTS
+ *         的结果与整段处理相同；CBC/CFB 加密、OFB 与 GCM 则相当于多条独立消息并发处理的总吞吐量。
+ *   另外给出密钥拓展与各模式对象构造的开销（ns/key、cycles/key）。
+ *
+ * cycles/byte 按 TSC 计数计算（与 OpenSSL speed 相同），开启睿频时与核心周期有偏差；
+ * 多线程时是墙钟时间内的 TSC 计数除以总字节数。非 x86 平台输出 null。
+ *
+ * 用法: ./sm4_bench_suite [--max-size BYTES] [--min-time SEC] [--threads N]
+ *                         [--backends a,b,...] [--modes ecb,ctr,...] [--out FILE] [--help]
+ * 进度输出到 stderr，JSON 输出到 stdout 或 --out 指定的文件。
+ */
+
+namespace {
+
+struct Options {
+    size_t maxSize = size_t(64) << 20;
+    double minTime = 0.1;
+    unsigned threads = 0;
+    std::vector<std::string> backends;  // 空表示本机支持的全部后端
+    std::vector<std::string> modes;     // 空表示全部模式
+    std::string out;
+    bool help = false;
+};
+
+const std::vector<std::string> MODES = {
+    "ecb", "ctr", "cbc-enc", "cbc-dec", "cfb-enc", "cfb-dec", "ofb", "cbc-dec-sm4", "gcm", "gcm-table",
+    "xts-512", "xts-4096", "xts-mmap-512", "xts-mmap-4096"
+};
+
+// 多线程测试的最小消息长度，更短时线程调度开销占主导
+constexpr size_t PARALLEL_MIN_BYTES = 64 * 1024;
+
+// 位切片与参考实现上串行模式的最大长度
+constexpr size_t SLOW_SERIAL_MAX_BYTES = size_t(4) << 20;
+
+// 与后端无关的对照模式，只在第一个后端上测一次，结果的 backend 记为 "SM4::decrypt"
+const char* const REFERENCE_MODE = "cbc-dec-sm4";
+
+struct Sample {
+    double seconds = 0;
+    uint64_t cycles = 0;
+    uint64_t iterations = 0;
+};
+
+inline uint64_t tsc() {
+#ifdef SM4_BENCH_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/*
+ * 重复执行 run 直到累计耗时不少于 minTime
+ * 短消息每轮的执行次数倍增，使计时开销可以忽略；单次已超过 minTime 的大消息不再预热
+ */
+Sample measure(const std::function<void()>& run, double minTime) {
+    using Clock = std::chrono::steady_clock;
+    Sample s;
+    auto t0 = Clock::now();
+    uint64_t c0 = tsc();
+    run();
+    double first = std::chrono::duration<double>(Clock::now() - t0).count();
+    if (first >= minTime) {
+        s.seconds = first;
+        s.cycles = tsc() - c0;
+        s.iterations = 1;
+        return s;
+    }
+
+    uint64_t reps = 1;
+    while (s.seconds < minTime) {
+        t0 = Clock::now();
+        c0 = tsc();
+        for (uint64_t i = 0; i < reps; ++i) run();
+        uint64_t c1 = tsc();
+        double dt = std::chrono::duration<double>(Clock::now() - t0).count();
+        s.seconds += dt;
+        s.cycles += c1 - c0;
+        s.iterations += reps;
+        if (dt < 1e-3) reps *= 2;
+    }
+    return s;
+}
+
+std::vector<std::string> splitList(const std::string& s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(item);
+    }
+    return out;
+}
+
+bool contains(const std::vector<std::string>& v, const std::string& s) {
+    return std::find(v.begin(), v.end(), s) != v.end();
+}
+
+std::string jsonString(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) out += c;
+    }
+    return out + "\"";
+}
+
+std::string jsonNumber(double v, int precision) {
+    std::ostringstream os;
+    os.setf(std::ios::fixed);
+    os.precision(precision);
+    os << v;
+    return os.str();
+}
+
+std::string cpuModel() {
+    std::ifstream in("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            size_t p = line.find(':');
+            if (p != std::string::npos) return line.substr(line.find_first_not_of(' ', p + 1));
+        }
+    }
+    return "unknown";
+}
+
+std::string sizeLabel(size_t n) {
+    if (n >= (size_t(1) << 30)) return std::to_string(n >> 30) + " GiB";
+    if (n >= (size_t(1) << 20)) return std::to_string(n >> 20) + " MiB";
+    if (n >= 1024) return std::to_string(n >> 10) + " KiB";
+    return std::to_string(n) + " B";
+}
+
+/*
+ * 一个模式的被测操作：op(in, out, len) 处理一段消息
+ * 对象在构造时绑定到指定后端的分组内核
+ */
+typedef std::function<void(const uint8_t*, uint8_t*, size_t)> ModeOp;
+
+const uint8_t KEY[16] = {
+    0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF,
+    0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10
+};
+const uint8_t IV[16] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F
+};
+
+// 各模式处理的最小单位：XTS 为一个扇区，其余为一个分组
+size_t modeUnit(const std::string& mode) {
+    if (mode == "xts-512" || mode == "xts-mmap-512") return 512;
+    if (mode == "xts-4096" || mode == "xts-mmap-4096") return 4096;
+    return SM4::BLOCK_SIZE;
+}
+
+bool mmapMode(const std::string& mode) {
+    return mode.compare(0, 9, "xts-mmap-") == 0;
+}
+
+// 每个分组都要等上一个分组的模式，吞吐量由单分组内核的延迟决定
+bool serialMode(const std::string& mode) {
+    return mode == "cbc-enc" || mode == "cfb-enc" || mode == "ofb" || mode == REFERENCE_MODE;
+}
+
+/*
+ * 在临时文件的内存映射上模拟磁盘镜像，XTS 在映射上原地加密
+ * 文件创建后即删除，映射解除后空间自动回收
+ */
+class MappedImage {
+public:
+    explicit MappedImage(size_t bytes) : len(bytes) {
+        char path[] = "/tmp/sm4_bench_XXXXXX";
+        int fd = mkstemp(path);
+        if (fd < 0) return;
+        unlink(path);
+        if (ftruncate(fd, off_t(bytes)) == 0) {
+            void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED) map = static_cast<uint8_t*>(p);
+        }
+        close(fd);
+    }
+    ~MappedImage() {
+        if (map) munmap(map, len);
+    }
+    MappedImage(const MappedImage&) = delete;
+    MappedImage& operator=(const MappedImage&) = delete;
+
+    uint8_t* data() const { return map; }
+
+private:
+    uint8_t* map = nullptr;
+    size_t len;
+};
+
+struct ModeBench {
+    std::unique_ptr<SM4_CTR> ctr;
+    std::unique_ptr<SM4_CBC> cbc;
+    std::unique_ptr<SM4_CFB> cfb;
+    std::unique_ptr<SM4_OFB> ofb;
+    std::unique_ptr<SM4_GCM> gcm;
+    std::unique_ptr<SM4_GCM> gcmTable;
+    std::unique_ptr<SM4_XTS> xts;
+    SM4 sm4;
+    uint32_t rk[32];
+    SM4BlocksFn blocks;
+
+    explicit ModeBench(SM4BlocksFn blocks)
+        : ctr(new SM4_CTR(KEY, IV, blocks)), cbc(new SM4_CBC(KEY, blocks)), cfb(new SM4_CFB(KEY, blocks)),
+          ofb(new SM4_OFB(KEY, blocks)), gcm(new SM4_GCM(KEY, blocks)), gcmTable(new SM4_GCM(KEY, blocks)),
+          sm4(std::vector<unsigned char>(KEY, KEY + 16)), blocks(blocks) {
+        SM4::keyGenerate(KEY, rk);
+        gcmTable->useClmul(false);
+        uint8_t xtsKey[SM4_XTS::KEY_SIZE];
+        std::memcpy(xtsKey, KEY, 16);
+        std::memcpy(xtsKey + 16, IV, 16);
+        xts.reset(new SM4_XTS(xtsKey, blocks));
+    }
+
+    // 长度按分组对齐（16 B 起步，各模式都处理整分组）
+    ModeOp op(const std::string& mode) const {
+        if (mode == "ecb") {
+            return [this](const uint8_t* in, uint8_t* out, size_t len) {
+                blocks(rk, in, out, len / SM4::BLOCK_SIZE);
+            };
+        }
+        if (mode == "ctr") {
+            return [this](const uint8_t* in, uint8_t* out, size_t len) { ctr->crypt(in, out, len); };
+        }
+        if (mode == "cbc-enc" || mode == "cbc-dec") {
+            bool dec = mode == "cbc-dec";
+            return [this, dec](const uint8_t* in, uint8_t* out, size_t len) {
+                uint8_t iv[16];
+                std::memcpy(iv, IV, 16);
+                if (dec) {
+                    cbc->decrypt(iv, in, out, len / SM4::BLOCK_SIZE);
+                } else {
+                    cbc->encrypt(iv, in, out, len / SM4::BLOCK_SIZE);
+                }
+            };
+        }
+        if (mode == "cfb-enc" || mode == "cfb-dec") {
+            bool dec = mode == "cfb-dec";
+            return [this, dec](const uint8_t* in, uint8_t* out, size_t len) {
+                uint8_t iv[16];
+                std::memcpy(iv, IV, 16);
+                if (dec) {
+                    cfb->decrypt(iv, in, out, len);
+                } else {
+                    cfb->encrypt(iv, in, out, len);
+                }
+            };
+        }
+        if (mode == "ofb") {
+            return [this](const uint8_t* in, uint8_t* out, size_t len) {
+                uint8_t iv[16];
+                std::memcpy(iv, IV, 16);
+                ofb->crypt(iv, in, out, len);
+            };
+        }
+        if (mode == REFERENCE_MODE) {
+            // 旧接口：每个分组一次 SM4::decrypt 调用，输入输出都是 std::vector
+            return [this](const uint8_t* in, uint8_t* out, size_t len) {
+                std::vector<unsigned char> block(SM4::BLOCK_SIZE);
+                const uint8_t* prev = IV;
+                for (size_t i = 0; i < len; i += SM4::BLOCK_SIZE) {
+                    block.assign(in + i, in + i + SM4::BLOCK_SIZE);
+                    std::vector<unsigned char> p = sm4.decrypt(block);
+                    for (size_t j = 0; j < SM4::BLOCK_SIZE; ++j) out[i + j] = p[j] ^ prev[j];
+                    prev = in + i;
+                }
+            };
+        }
+        if (mode.compare(0, 4, "xts-") == 0) {
+            size_t sector = modeUnit(mode);
+            // 线程由套件自己分配，XTS 内部不再使用线程池；xts-mmap 的 in 与 out 都是映射的镜像
+            return [this, sector](const uint8_t* in, uint8_t* out, size_t len) {
+                xts->encryptSectors(0, in, out, sector, len / sector, 1);
+            };
+        }
+        const SM4_GCM* g = mode == "gcm" ? gcm.get() : gcmTable.get();
+        return [g](const uint8_t* in, uint8_t* out, size_t len) {
+            uint8_t tag[16];
+            g->encrypt(IV, 12, nullptr, 0, in, out, len, tag);
+        };
+    }
+};
+
+struct Result {
+    std::string mode;
+    std::string backend;
+    size_t bytes;
+    unsigned threads;
+    Sample sample;
+};
+
+struct SetupResult {
+    std::string name;
+    Sample sample;
+    size_t keys;
+};
+
+void writeSample(std::ostream& os, const Sample& s, double units, const char* perUnit) {
+    os << "\"iterations\": " << s.iterations;
+    os << ", \"seconds\": " << jsonNumber(s.seconds, 6);
+    os << ", \"cycles_" << perUnit << "\": ";
+#ifdef SM4_BENCH_TSC
+    os << jsonNumber(double(s.cycles) / units, 3);
+#else
+    os << "null";
+#endif
+}
+
+void writeJson(std::ostream& os, const Options& opt, unsigned threads, const std::vector<SetupResult>& setup,
+               const std::vector<Result>& results) {
+    char stamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    os << "{\n";
+    os << "  \"suite\": \"sm4\",\n";
+    os << "  \"schema\": 1,\n";
+    os << "  \"timestamp\": " << jsonString(stamp) << ",\n";
+    os << "  \"cpu\": {\"model\": " << jsonString(cpuModel())
+       << ", \"logical_cpus\": " << std::thread::hardware_concurrency()
+       << ", \"ssse3_aesni\": " << (SM4_SIMD::hasSSE() ? "true" : "false")
+       << ", \"avx2\": " << (SM4_SIMD::hasAVX2() ? "true" : "false")
+       << ", \"avx512\": " << (SM4_SIMD::hasAVX512() ? "true" : "false")
+       << ", \"gfni\": " << (SM4_SIMD::hasAVX2GFNI() || SM4_SIMD::hasAVX512GFNI() ? "true" : "false")
+       << ", \"pclmul\": " << (SM4_GCM::hasPCLMUL() ? "true" : "false") << "},\n";
+    os << "  \"auto_backend\": " << jsonString(SM4Engine::backendName()) << ",\n";
+    os << "  \"ghash\": " << jsonString(SM4Engine::ghashClmul() ? "pclmul" : "table") << ",\n";
+    os << "  \"threads\": " << threads << ",\n";
+    os << "  \"min_time\": " << jsonNumber(opt.minTime, 3) << ",\n";
+
+    os << "  \"key_setup\": [\n";
+    for (size_t i = 0; i < setup.size(); ++i) {
+        const SetupResult& r = setup[i];
+        double perKey = r.sample.seconds / double(r.sample.iterations * r.keys);
+        os << "    {\"name\": " << jsonString(r.name) << ", \"ns_per_key\": " << jsonNumber(perKey * 1e9, 2)
+           << ", ";
+        writeSample(os, r.sample, double(r.sample.iterations * r.keys), "per_key");
+        os << "}" << (i + 1 < setup.size() ? "," : "") << "\n";
+    }
+    os << "  ],\n";
+
+    os << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        double total = double(r.bytes) * double(r.sample.iterations);
+        os << "    {\"mode\": " << jsonString(r.mode) << ", \"backend\": " << jsonString(r.backend)
+           << ", \"bytes\": " << r.bytes << ", \"threads\": " << r.threads
+           << ", \"gbps\": " << jsonNumber(total / r.sample.seconds / 1e9, 4) << ", ";
+        writeSample(os, r.sample, total, "per_byte");
+        os << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n";
+    os << "}\n";
+}
+
+void usage(std::ostream& os, const char* prog) {
+    os << "usage: " << prog << " [--max-size BYTES] [--min-time SEC] [--threads N]"
+       << " [--backends a,b,...] [--modes ecb,ctr,...] [--out FILE] [--help]\n"
+       << "modes:";
+    for (const auto& m : MODES) os << " " << m;
+    os << "\nbackends:";
+    for (const auto& b : SM4Engine::backends()) os << " " << b.name;
+    os << "\n";
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--help" || a == "-h") {
+            opt.help = true;
+            return true;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << a << "\n";
+            return false;
+        }
+        std::string v = argv[++i];
+        try {
+            if (a == "--max-size") {
+                opt.maxSize = std::stoull(v);
+            } else if (a == "--min-time") {
+                opt.minTime = std::stod(v);
+            } else if (a == "--threads") {
+                opt.threads = unsigned(std::stoul(v));
+            } else if (a == "--backends") {
+                opt.backends = splitList(v);
+            } else if (a == "--modes") {
+                opt.modes = splitList(v);
+            } else if (a == "--out") {
+                opt.out = v;
+            } else {
+                std::cerr << "unknown option " << a << "\n";
+                return false;
+            }
+        } catch (const std::exception&) {
+            // std::stoull / stod / stoul 对非数字或越界的值抛出异常
+            std::cerr << "invalid value for " << a << ": " << v << "\n";
+            return false;
+        }
+    }
+    for (const auto& m : opt.modes) {
+        if (!contains(MODES, m)) {
+            std::cerr << "unknown mode " << m << "\n";
+            return false;
+        }
+    }
+    if (opt.modes.empty()) opt.modes = MODES;
+    return opt.maxSize >= SM4::BLOCK_SIZE;
+}
+
+std::vector<SetupResult> benchKeySetup(double minTime) {
+    const size_t nkeys = 1024;
+    std::vector<uint8_t> keys(nkeys * 16);
+    for (size_t i = 0; i < keys.size(); ++i) keys[i] = uint8_t(i * 131 + 17);
+    std::vector<SM4Context> ctxs(nkeys);
+    SM4KeyCache cache(nkeys);
+    for (size_t i = 0; i < nkeys; ++i) cache.get(keys.data() + i * 16, ctxs[i]);
+
+    std::vector<SetupResult> out;
+    out.push_back({"SM4::initContext", measure([&] {
+        for (size_t i = 0; i < nkeys; ++i) SM4::initContext(keys.data() + i * 16, ctxs[i]);
+    }, minTime), nkeys});
+    out.push_back({"SM4_SIMD::keyGenerateBatch", measure([&] {
+        SM4_SIMD::keyGenerateBatch(keys.data(), ctxs.data(), nkeys);
+    }, minTime), nkeys});
+    out.push_back({"SM4KeyCache hit", measure([&] {
+        for (size_t i = 0; i < nkeys; ++i) cache.get(keys.data() + i * 16, ctxs[i]);
+    }, minTime), nkeys});
+    // 各模式对象的完整构造：CBC 含解密轮密钥，GCM 含 H 与 GHASH 表的预计算
+    out.push_back({"SM4_CTR setup", measure([&] { SM4_CTR ctr(KEY, IV); (void)ctr; }, minTime), 1});
+    out.push_back({"SM4_CBC setup", measure([&] { SM4_CBC cbc(KEY); (void)cbc; }, minTime), 1});
+    out.push_back({"SM4_GCM setup", measure([&] { SM4_GCM gcm(KEY); (void)gcm; }, minTime), 1});
+    uint8_t xtsKey[SM4_XTS::KEY_SIZE] = {0};
+    std::memcpy(xtsKey, KEY, 16);
+    out.push_back({"SM4_XTS setup", measure([&] { SM4_XTS xts(xtsKey); (void)xts; }, minTime), 1});
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        usage(std::cerr, argv[0]);
+        return 1;
+    }
+    if (opt.help) {
+        usage(std::cout, argv[0]);
+        return 0;
+    }
+
+    std::vector<size_t> sizes;
+    for (size_t n = SM4::BLOCK_SIZE; n <= opt.maxSize; n *= 4) {
+        sizes.push_back(n);
+        if (n > opt.maxSize / 4) break;
+    }
+
+    unsigned threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::unique_ptr<ThreadPool> pool;
+    if (threads > 1) pool.reset(new ThreadPool(threads));
+
+    size_t maxBytes = sizes.back();
+    std::vector<uint8_t> in(maxBytes), out(maxBytes);
+    for (size_t i = 0; i < maxBytes; ++i) in[i] = uint8_t(i * 31 + 7);
+
+    std::cerr << "SM4 benchmark suite: " << sizes.size() << " sizes up to " << sizeLabel(maxBytes) << ", "
+              << threads << " threads, auto backend " << SM4Engine::backendName() << "\n";
+
+    std::unique_ptr<MappedImage> image;
+    if (std::any_of(opt.modes.begin(), opt.modes.end(), mmapMode)) {
+        image.reset(new MappedImage(maxBytes));
+        if (image->data()) {
+            std::memcpy(image->data(), in.data(), maxBytes);
+        } else {
+            std::cerr << "cannot map a " << sizeLabel(maxBytes) << " image file, skipping xts-mmap\n";
+        }
+    }
+
+    std::vector<SetupResult> setup = benchKeySetup(opt.minTime);
+    std::vector<Result> results;
+    bool referenceDone = false;
+    for (const auto& b : SM4Engine::backends()) {
+        if (!b.supported()) continue;
+        if (!opt.backends.empty() && !contains(opt.backends, b.name)) continue;
+        ModeBench bench(b.blocks);
+        bool slow = b.blocks == SM4::cryptBlocks || b.blocks == SM4_Bitsliced::cryptBlocks;
+
+        for (const auto& mode : opt.modes) {
+            bool reference = mode == REFERENCE_MODE;
+            if (reference && referenceDone) continue;
+            if (mmapMode(mode) && !image->data()) continue;
+            referenceDone = referenceDone || reference;
+            const std::string backend = reference ? "SM4::decrypt" : b.name;
+            const uint8_t* src = mmapMode(mode) ? image->data() : in.data();
+            uint8_t* dst = mmapMode(mode) ? image->data() : out.data();
+            ModeOp op = bench.op(mode);
+            size_t unit = modeUnit(mode);
+            for (size_t bytes : sizes) {
+                if (bytes < unit) continue;
+                if ((slow || reference) && serialMode(mode) && bytes > SLOW_SERIAL_MAX_BYTES) continue;
+                Sample s = measure([&] { op(src, dst, bytes); }, opt.minTime);
+                results.push_back({mode, backend, bytes, 1, s});
+                std::cerr << "  " << mode << " " << backend << " " << sizeLabel(bytes) << ": "
+                          << jsonNumber(double(bytes) * s.iterations / s.seconds / 1e9, 3) << " GB/s\n";
+
+                if (!pool || bytes < PARALLEL_MIN_BYTES) continue;
+                // 每段按分组（XTS 按扇区）对齐，最后一段承担余数
+                size_t chunk = bytes / threads / unit * unit;
+                s = measure([&] {
+                    pool->parallelFor(threads, [&](size_t t) {
+                        size_t begin = t * chunk;
+                        size_t len = t + 1 == threads ? bytes - begin : chunk;
+                        op(src + begin, dst + begin, len);
+                    });
+                }, opt.minTime);
+                results.push_back({mode, backend, bytes, threads, s});
+                std::cerr << "  " << mode << " " << backend << " " << sizeLabel(bytes) << " x" << threads << ": "
+                          << jsonNumber(double(bytes) * s.iterations / s.seconds / 1e9, 3) << " GB/s\n";
+            }
+        }
+    }
+
+    if (opt.out.empty()) {
+        writeJson(std::cout, opt, threads, setup, results);
+    } else {
+        std::ofstream file(opt.out);
+        if (!file) {
+            std::cerr << "cannot open " << opt.out << "\n";
+            return 1;
+        }
+        writeJson(file, opt, threads, setup, results);
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include "sm4_ctr.h"
+#include "sm4_engine.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 每次交给批量内核的分组数：覆盖 AVX-512 的 16 路与位切片的 256 路，缓冲区 4 KB
+constexpr size_t CTR_BATCH = 256;
+
+// 单线程区间下限：小于该长度时多线程的调度开销得不偿失
+constexpr size_t PARALLEL_MIN_BYTES = 256 * 1024;
+
+inline uint64_t loadBE64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return __builtin_bswap64(v);
+}
+
+inline void storeBE64(uint64_t v, uint8_t* p) {
+    v = __builtin_bswap64(v);
+    std::memcpy(p, &v, 8);
+}
+
+} // namespace
+
+void SM4_CTR::counterAdd(const uint8_t iv[16], uint64_t n, uint8_t ctr[16]) {
+    uint64_t hi = loadBE64(iv);
+    uint64_t lo = loadBE64(iv + 8);
+    uint64_t sum = lo + n;
+    hi += (sum < lo); // 低 64 位进位
+    storeBE64(hi, ctr);
+    storeBE64(sum, ctr + 8);
+}
+
+void SM4_CTR::xorKeystream(SM4BlocksFn blocks, const uint32_t rk[32], const uint8_t ctr0[16],
+                           const uint8_t* in, uint8_t* out, size_t nblocks) {
+    alignas(64) uint8_t ks[CTR_BATCH * SM4::BLOCK_SIZE];
+    uint64_t hi = loadBE64(ctr0);
+    uint64_t lo = loadBE64(ctr0 + 8);
+
+    while (nblocks) {
+        size_t n = std::min(nblocks, CTR_BATCH);
+        for (size_t i = 0; i < n; ++i) {
+            storeBE64(hi, ks + i * SM4::BLOCK_SIZE);
+            storeBE64(lo, ks + i * SM4::BLOCK_SIZE + 8);
+            hi += (++lo == 0);
+        }
+        blocks(rk, ks, ks, n);
+
+        size_t bytes = n * SM4::BLOCK_SIZE;
+        for (size_t i = 0; i < bytes; i += 8) {
+            uint64_t a, k;
+            std::memcpy(&a, in + i, 8);
+            std::memcpy(&k, ks + i, 8);
+            a ^= k;
+            std::memcpy(out + i, &a, 8);
+        }
+        in += bytes;
+        out += bytes;
+        nblocks -= n;
+    }
+}
+
+SM4_CTR::SM4_CTR(const uint8_t key[16], const uint8_t iv[16], SM4BlocksFn blocks)
+    : blocks(blocks ? blocks : SM4Engine::blocks()) {
+    SM4::keyGenerate(key, key_r);
+    std::memcpy(this->iv, iv, 16);
+}
+
+SM4_CTR::SM4_CTR(const std::vector<unsigned char>& key, const std::vector<unsigned char>& iv,
+                 SM4BlocksFn blocks)
+    : SM4_CTR(key.data(), iv.data(), blocks) {}
+
+void SM4_CTR::crypt(const uint8_t* in, uint8_t* out, size_t len, uint64_t offset) const {
+    uint8_t ctr[16];
+    uint64_t block = offset / SM4::BLOCK_SIZE;
+    size_t skip = size_t(offset % SM4::BLOCK_SIZE);
+
+    // 起始偏移不在分组边界：生成一个密钥流分组，只使用其后半部分
+    if (skip && len) {
+        uint8_t ks[16];
+        counterAdd(iv, block, ctr);
+        blocks(key_r, ctr, ks, 1);
+        size_t n = std::min(len, SM4::BLOCK_SIZE - skip);
+        for (size_t i = 0; i < n; ++i) out[i] = in[i] ^ ks[skip + i];
+        in += n;
+        out += n;
+        len -= n;
+        ++block;
+    }
+
+    // 中间整分组
+    size_t full = len / SM4::BLOCK_SIZE;
+    if (full) {
+        counterAdd(iv, block, ctr);
+        xorKeystream(blocks, key_r, ctr, in, out, full);
+        in += full * SM4::BLOCK_SIZE;
+        out += full * SM4::BLOCK_SIZE;
+        len -= full * SM4::BLOCK_SIZE;
+        block += full;
+    }
+
+    // 末尾不足一个分组
+    if (len) {
+        uint8_t ks[16];
+        counterAdd(iv, block, ctr);
+        blocks(key_r, ctr, ks, 1);
+        for (size_t i = 0; i < len; ++i) out[i] = in[i] ^ ks[i];
+    }
+}
+
+void SM4_CTR::cryptParallel(const uint8_t* in, uint8_t* out, size_t len, uint64_t offset,
+                            unsigned threads) const {
+    ThreadPool& pool = ThreadPool::global();
+    size_t maxTasks = threads ? threads : pool.size();
+    size_t tasks = std::min(maxTasks, len / PARALLEL_MIN_BYTES);
+    if (tasks <= 1) {
+        crypt(in, out, len, offset);
+        return;
+    }
+
+    // 区间长度取分组大小的整数倍，只有最后一段可能以不完整分组结尾
+    size_t chunk = (len / tasks + SM4::BLOCK_SIZE - 1) / SM4::BLOCK_SIZE * SM4::BLOCK_SIZE;
+    pool.parallelFor(tasks, [&](size_t t) {
+        size_t begin = t * chunk;
+        if (begin >= len) return;
+        size_t n = std::min(chunk, len - begin);
+        crypt(in + begin, out + begin, n, offset + begin);
+    });
+}
+
+void SM4_CTR::update(const uint8_t* in, uint8_t* out, size_t len) {
+    crypt(in, out, len, position);
+    position += len;
+}
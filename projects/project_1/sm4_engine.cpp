@@ -0,0 +1,153 @@
+#include "sm4_engine.h"
+#include "SM4_T_Table.h"
+#include "SM4_SIMD.h"
+#include "SM4_Bitslice.h"
+#include "sm4_gcm.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+bool always() { return true; }
+
+#define SM4_BACKEND_ENTRY(name, supported, fn, serial, batch) { name, supported, fn, serial, batch }
+
+// 按自动选择的优先级排列；位切片恒定时间、批量吞吐高于 T 表，少量分组走不补齐的窄路径，作为无 AES-NI 时的默认
+const std::vector<SM4Engine::Backend>& table() {
+    static const std::vector<SM4Engine::Backend> t = {
+        SM4_BACKEND_ENTRY("avx512-gfni", SM4_SIMD::hasAVX512GFNI, SM4_SIMD::cryptBlocksAVX512GFNI,
+                          SM4_SIMD::cryptSerialGFNI, 16),
+        SM4_BACKEND_ENTRY("avx512", SM4_SIMD::hasAVX512, SM4_SIMD::cryptBlocksAVX512, SM4_SIMD::cryptSerialSSE, 16),
+        SM4_BACKEND_ENTRY("avx2-gfni", SM4_SIMD::hasAVX2GFNI, SM4_SIMD::cryptBlocksAVX2GFNI,
+                          SM4_SIMD::cryptSerialGFNI, 16),
+        SM4_BACKEND_ENTRY("avx2", SM4_SIMD::hasAVX2, SM4_SIMD::cryptBlocksAVX2, SM4_SIMD::cryptSerialSSE, 16),
+        SM4_BACKEND_ENTRY("sse", SM4_SIMD::hasSSE, SM4_SIMD::cryptBlocksSSE, SM4_SIMD::cryptSerialSSE, 16),
+        SM4_BACKEND_ENTRY("bitslice", always, SM4_Bitsliced::cryptBlocks, SM4_Bitsliced::cryptFew, 256),
+        SM4_BACKEND_ENTRY("ttable", always, OptimizedSM4::cryptBlocks, OptimizedSM4::cryptBlocks, 16),
+        SM4_BACKEND_ENTRY("ref", always, SM4::cryptBlocks, SM4::cryptBlocks, 16),
+    };
+    return t;
+}
+
+#undef SM4_BACKEND_ENTRY
+
+const SM4Engine::Backend* autoBackend() {
+    for (const auto& b : table()) {
+        if (b.supported()) return &b;
+    }
+    return &table().back();
+}
+
+// 名称为 "auto" 时自动选择；无效或不支持时返回 nullptr
+const SM4Engine::Backend* findBackend(const std::string& name) {
+    if (name == "auto") return autoBackend();
+    for (const auto& b : table()) {
+        if (name == b.name) return b.supported() ? &b : nullptr;
+    }
+    return nullptr;
+}
+
+const SM4Engine::Backend* initialBackend() {
+    const char* env = std::getenv("SM4_BACKEND");
+    if (env && *env) {
+        if (const SM4Engine::Backend* b = findBackend(env)) return b;
+        std::cerr << "SM4_BACKEND=" << env << " is unknown or unsupported on this CPU, using auto\n";
+    }
+    return autoBackend();
+}
+
+bool initialGhash() {
+    const char* env = std::getenv("SM4_GHASH");
+    if (env && *env && std::strcmp(env, "auto") != 0) {
+        if (std::strcmp(env, "table") == 0) return false;
+        if (std::strcmp(env, "pclmul") == 0 && SM4_GCM::hasPCLMUL()) return true;
+        std::cerr << "SM4_GHASH=" << env << " is unknown or unsupported on this CPU, using auto\n";
+    }
+    return SM4_GCM::hasPCLMUL();
+}
+
+// 当前选择：函数内静态变量保证首次使用时线程安全地初始化
+std::atomic<const SM4Engine::Backend*>& backendSlot() {
+    static std::atomic<const SM4Engine::Backend*> slot{initialBackend()};
+    return slot;
+}
+
+std::atomic<bool>& ghashSlot() {
+    static std::atomic<bool> slot{initialGhash()};
+    return slot;
+}
+
+} // namespace
+
+const std::vector<SM4Engine::Backend>& SM4Engine::backends() {
+    return table();
+}
+
+const SM4Engine::Backend* SM4Engine::find(SM4BlocksFn blocks) {
+    for (const auto& b : table()) {
+        if (b.blocks == blocks) return &b;
+    }
+    return nullptr;
+}
+
+const SM4Engine::Backend& SM4Engine::backend() {
+    return *backendSlot().load(std::memory_order_acquire);
+}
+
+bool SM4Engine::ghashClmul() {
+    return ghashSlot().load(std::memory_order_relaxed);
+}
+
+bool SM4Engine::selectBackend(const std::string& name) {
+    const Backend* b = findBackend(name);
+    if (!b) return false;
+    backendSlot().store(b, std::memory_order_release);
+    return true;
+}
+
+bool SM4Engine::selectGhash(const std::string& name) {
+    bool clmul;
+    if (name == "auto") {
+        clmul = SM4_GCM::hasPCLMUL();
+    } else if (name == "table") {
+        clmul = false;
+    } else if (name == "pclmul" && SM4_GCM::hasPCLMUL()) {
+        clmul = true;
+    } else {
+        return false;
+    }
+    ghashSlot().store(clmul, std::memory_order_relaxed);
+    return true;
+}
+
+SM4Engine::SM4Engine(const uint8_t key[16]) {
+    SM4::initContext(key, ctx);
+}
+
+SM4Engine::SM4Engine(const std::vector<unsigned char>& key)
+    : SM4Engine(key.data()) {}
+
+SM4Engine::SM4Engine(const SM4Context& ctx)
+    : ctx(ctx) {}
+
+void SM4Engine::encrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const {
+    blocks()(ctx.rk_enc, in, out, nblocks);
+}
+
+void SM4Engine::decrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const {
+    blocks()(ctx.rk_dec, in, out, nblocks);
+}
+
+std::vector<unsigned char> SM4Engine::encrypt(const std::vector<unsigned char>& plaintext) const {
+    std::vector<unsigned char> output(SM4::BLOCK_SIZE);
+    encrypt_blocks(plaintext.data(), output.data(), 1);
+    return output;
+}
+
+std::vector<unsigned char> SM4Engine::decrypt(const std::vector<unsigned char>& ciphertext) const {
+    std::vector<unsigned char> output(SM4::BLOCK_SIZE);
+    decrypt_blocks(ciphertext.data(), output.data(), 1);
+    return output;
+}
@@ -0,0 +1,75 @@
+#ifndef SM4_ENGINE_H
+#define SM4_ENGINE_H
+
+#include "sm4.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * SM4Engine
+ * 统一前端：同一个二进制部署到不同代的 CPU 上，首次使用时探测 CPU（SSSE3、AVX2、AVX-512、GFNI、
+ * PCLMULQDQ），把分组内核与 GCM 的 GHASH 后端绑定到当前 CPU 上最快的正确实现。
+ * SM4_CTR、SM4_GCM、SM4_CBC、SM4_XTS 等不指定内核时都使用这里选出的内核；CTR 与 GCM 的计数器
+ * 分组由 SM4_CTR::xorKeystream 成批交给分组内核，不需要单独的 CTR 内核。
+ *
+ * 环境变量（用于 A/B 基准测试）：
+ *   SM4_BACKEND = auto | avx512-gfni | avx512 | avx2-gfni | avx2 | sse | bitslice | ttable | ref
+ *   SM4_GHASH   = auto | pclmul | table
+ * 指定的后端当前 CPU 不支持或名称无效时，向 stderr 输出警告并回退到 auto。
+ */
+class SM4Engine {
+public:
+    /*
+     * 一个分组内核后端
+     * serial 是同一族的单分组内核，供 CBC/CFB 加密、OFB 这类串行链逐个分组调用，不补齐到 blocks 的宽度；
+     * batch 是 blocks 一次调用的合适分组数（内核宽度的整数倍），并行解密按它分批，不引入补齐
+     */
+    struct Backend {
+        const char* name;
+        bool (*supported)();
+        SM4BlocksFn blocks;
+        SM4BlocksFn serial;
+        size_t batch;
+    };
+
+    explicit SM4Engine(const std::vector<unsigned char>& key);
+    explicit SM4Engine(const uint8_t key[16]);
+    explicit SM4Engine(const SM4Context& ctx);
+
+    // 单分组接口，与 SM4 相同
+    std::vector<unsigned char> encrypt(const std::vector<unsigned char>& plaintext) const;
+    std::vector<unsigned char> decrypt(const std::vector<unsigned char>& ciphertext) const;
+
+    // 批量 ECB 接口，使用当前后端
+    void encrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const;
+    void decrypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks) const;
+
+    /* ---------------- 进程级分派 ---------------- */
+
+    // 当前后端；首次调用时读取环境变量并探测 CPU
+    static const Backend& backend();
+    static const char* backendName() { return backend().name; }
+    static SM4BlocksFn blocks() { return backend().blocks; }
+    // blocks 所属的后端；不是表中的内核（调用者自带的内核）时返回 nullptr
+    static const Backend* find(SM4BlocksFn blocks);
+
+    // GCM 是否使用 PCLMULQDQ 计算 GHASH
+    static bool ghashClmul();
+
+    /*
+     * 运行时切换后端（"auto" 重新自动选择），名称无效或 CPU 不支持时返回 false 且保持不变
+     * 只影响之后创建的对象，已创建的模式对象保留构造时的内核
+     */
+    static bool selectBackend(const std::string& name);
+    static bool selectGhash(const std::string& name);
+
+    // 全部后端，按自动选择的优先级排列
+    static const std::vector<Backend>& backends();
+
+private:
+    SM4Context ctx;
+};
+
+#endif // SM4_ENGINE_H
@@ -0,0 +1,403 @@
+#include "sm4_file.h"
+#include "sm4_ctr.h"
+#include "sm4_gcm.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const uint8_t MAGIC[4] = {'S', 'M', '4', 'F'};
+constexpr uint8_t VERSION = 1;
+
+// GCM 块 AAD：文件头 || 块序号（8 字节大端）|| 末块标志
+constexpr size_t AAD_SIZE = SM4FileCipher::HEADER_SIZE + 9;
+
+void storeBE32(uint32_t v, uint8_t* p) {
+    for (int i = 3; i >= 0; --i, v >>= 8) p[i] = uint8_t(v);
+}
+
+void storeBE64(uint64_t v, uint8_t* p) {
+    for (int i = 7; i >= 0; --i, v >>= 8) p[i] = uint8_t(v);
+}
+
+uint32_t loadBE32(const uint8_t* p) {
+    return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | p[3];
+}
+
+void secureZero(void* p, size_t n) {
+    volatile uint8_t* v = static_cast<volatile uint8_t*>(p);
+    while (n--) *v++ = 0;
+}
+
+std::string sysError(const char* what) {
+    return std::string(what) + ": " + std::strerror(errno);
+}
+
+bool preadAll(int fd, uint8_t* buf, size_t len, uint64_t off) {
+    while (len) {
+        ssize_t n = ::pread(fd, buf, len, off_t(off));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            if (n == 0) errno = EIO;  // 文件在处理期间被截短
+            return false;
+        }
+        buf += n;
+        len -= size_t(n);
+        off += uint64_t(n);
+    }
+    return true;
+}
+
+bool pwriteAll(int fd, const uint8_t* buf, size_t len, uint64_t off) {
+    while (len) {
+        ssize_t n = ::pwrite(fd, buf, len, off_t(off));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return false;
+        buf += n;
+        len -= size_t(n);
+        off += uint64_t(n);
+    }
+    return true;
+}
+
+/* 流水线中流转的块缓冲区 */
+struct Slot {
+    std::vector<uint8_t> buf;
+    uint64_t index = 0;
+};
+
+/* 阻塞队列：close 之后 pop 取完剩余元素再返回 nullptr */
+class SlotQueue {
+public:
+    void push(Slot* s) {
+        std::lock_guard<std::mutex> lock(mtx);
+        q.push_back(s);
+        cv.notify_one();
+    }
+
+    Slot* pop() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [&] { return !q.empty() || closed; });
+        if (q.empty()) return nullptr;
+        Slot* s = q.front();
+        q.pop_front();
+        return s;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+        cv.notify_all();
+    }
+
+private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<Slot*> q;
+    bool closed = false;
+};
+
+} // namespace
+
+/* 一次加解密任务的几何参数 */
+struct SM4FileCipher::Job {
+    bool decrypting;
+    Mode mode;
+    uint8_t header[HEADER_SIZE];
+    int inFd;
+    int outFd;
+    uint64_t inBase;    // 输入中第一块的偏移（解密时跳过文件头）
+    uint64_t inSize;    // 输入中块数据的总长度
+    uint64_t outBase;   // 输出中第一块的偏移
+    uint64_t outSize;   // 输出文件总长度
+    size_t chunk;       // 明文块长
+    size_t inStride;    // 输入中相邻块的间隔
+    size_t outStride;   // 输出中相邻块的间隔
+    uint64_t chunks;
+};
+
+SM4FileCipher::SM4FileCipher(const uint8_t key[16], Mode mode, size_t chunkSize, unsigned threads)
+    : mode(mode), chunkSize(chunkSize), threads(threads) {
+    std::memcpy(this->key, key, 16);
+}
+
+SM4FileCipher::~SM4FileCipher() {
+    secureZero(key, sizeof(key));
+}
+
+bool SM4FileCipher::encrypt(int inFd, int outFd, std::string* error) const {
+    if (chunkSize == 0 || chunkSize % SM4::BLOCK_SIZE || chunkSize > MAX_CHUNK) {
+        if (error) *error = "chunk size must be a non-zero multiple of 16 up to 64 MiB";
+        return false;
+    }
+    struct stat st;
+    if (::fstat(inFd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        if (error) *error = "input is not a regular file";
+        return false;
+    }
+
+    Job job;
+    job.decrypting = false;
+    job.mode = mode;
+    std::memset(job.header, 0, HEADER_SIZE);
+    std::memcpy(job.header, MAGIC, 4);
+    job.header[4] = VERSION;
+    job.header[5] = mode;
+    storeBE32(uint32_t(chunkSize), job.header + 8);
+    std::random_device rd;
+    for (int i = 0; i < 16; i += 4) storeBE32(rd(), job.header + 12 + i);
+
+    job.inFd = inFd;
+    job.outFd = outFd;
+    job.inBase = 0;
+    job.inSize = uint64_t(st.st_size);
+    job.outBase = HEADER_SIZE;
+    job.chunk = chunkSize;
+    job.inStride = chunkSize;
+    job.chunks = (job.inSize + chunkSize - 1) / chunkSize;
+    if (mode == GCM) {
+        job.outStride = chunkSize + SM4_GCM::TAG_SIZE;
+        job.chunks = std::max<uint64_t>(job.chunks, 1);
+        job.outSize = HEADER_SIZE + job.inSize + job.chunks * SM4_GCM::TAG_SIZE;
+    } else {
+        job.outStride = chunkSize;
+        job.outSize = HEADER_SIZE + job.inSize;
+    }
+    return run(job, error);
+}
+
+bool SM4FileCipher::decrypt(int inFd, int outFd, std::string* error) const {
+    struct stat st;
+    if (::fstat(inFd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        if (error) *error = "input is not a regular file";
+        return false;
+    }
+
+    Job job;
+    job.decrypting = true;
+    static const uint8_t zero[4] = {0};
+    if (uint64_t(st.st_size) < HEADER_SIZE || !preadAll(inFd, job.header, HEADER_SIZE, 0) ||
+        std::memcmp(job.header, MAGIC, 4) != 0 || job.header[4] != VERSION ||
+        (job.header[5] != CTR && job.header[5] != GCM) || std::memcmp(job.header + 6, zero, 2) != 0 ||
+        std::memcmp(job.header + 28, zero, 4) != 0) {
+        if (error) *error = "not an SM4F file or unsupported version";
+        return false;
+    }
+    job.mode = Mode(job.header[5]);
+    job.chunk = loadBE32(job.header + 8);
+    if (job.chunk == 0 || job.chunk % SM4::BLOCK_SIZE || job.chunk > MAX_CHUNK) {
+        if (error) *error = "invalid chunk size in header";
+        return false;
+    }
+
+    job.inFd = inFd;
+    job.outFd = outFd;
+    job.inBase = HEADER_SIZE;
+    job.inSize = uint64_t(st.st_size) - HEADER_SIZE;
+    job.outBase = 0;
+    job.outStride = job.chunk;
+    if (job.mode == GCM) {
+        job.inStride = job.chunk + SM4_GCM::TAG_SIZE;
+        job.chunks = (job.inSize + job.inStride - 1) / job.inStride;
+        uint64_t last = job.chunks ? job.inSize - (job.chunks - 1) * job.inStride : 0;
+        if (last < SM4_GCM::TAG_SIZE) {
+            if (error) *error = "truncated GCM chunk";
+            return false;
+        }
+        job.outSize = job.inSize - job.chunks * SM4_GCM::TAG_SIZE;
+    } else {
+        job.inStride = job.chunk;
+        job.chunks = (job.inSize + job.chunk - 1) / job.chunk;
+        job.outSize = job.inSize;
+    }
+    if (!run(job, error)) {
+        // 不留下部分解密或未通过认证的明文
+        int rc = ::ftruncate(outFd, 0);
+        (void)rc;
+        return false;
+    }
+    return true;
+}
+
+bool SM4FileCipher::run(const Job& job, std::string* error) const {
+    if (job.mode == GCM && job.chunks > (uint64_t(1) << 32)) {
+        if (error) *error = "too many chunks for one GCM nonce prefix";
+        return false;
+    }
+
+    const uint8_t* iv = job.header + 12;
+    SM4_CTR ctr(key, iv);
+    SM4_GCM gcm(key);
+
+    // 输入整体映射；映射失败（或禁用）时退回 pread
+    uint8_t* map = nullptr;
+    size_t mapLen = size_t(job.inBase + job.inSize);
+    if (mmapInput && job.inSize) {
+        void* p = ::mmap(nullptr, mapLen, PROT_READ, MAP_PRIVATE, job.inFd, 0);
+        if (p != MAP_FAILED) {
+            map = static_cast<uint8_t*>(p);
+            ::madvise(p, mapLen, MADV_SEQUENTIAL);
+        }
+    }
+
+    std::mutex errMtx;
+    std::string err;
+    std::atomic<bool> failed{false};
+    SlotQueue freeSlots, filled, done;
+    auto fail = [&](const std::string& msg) {
+        {
+            std::lock_guard<std::mutex> lock(errMtx);
+            if (err.empty()) err = msg;
+        }
+        failed.store(true);
+        freeSlots.close();
+        filled.close();
+        done.close();
+    };
+
+    if (::ftruncate(job.outFd, off_t(job.outSize)) != 0) {
+        fail(sysError("ftruncate"));
+    } else if (!job.decrypting && !pwriteAll(job.outFd, job.header, HEADER_SIZE, 0)) {
+        fail(sysError("pwrite"));
+    }
+
+    ThreadPool& pool = ThreadPool::global();
+    unsigned workers = threads ? threads : pool.size();
+    // 每个工作线程一块，另有一块在读、一块在写
+    std::vector<Slot> slots(workers + 2);
+    for (auto& s : slots) {
+        s.buf.resize(std::max(job.inStride, job.outStride));
+        freeSlots.push(&s);
+    }
+
+    auto inLength = [&](uint64_t i) {
+        return size_t(std::min<uint64_t>(job.inStride, job.inSize - i * job.inStride));
+    };
+
+    std::thread reader([&] {
+        for (uint64_t i = 0; i < job.chunks && !failed.load(); ++i) {
+            Slot* s = freeSlots.pop();
+            if (!s || failed.load()) break;
+            s->index = i;
+            if (!map && !preadAll(job.inFd, s->buf.data(), inLength(i), job.inBase + i * job.inStride)) {
+                fail(sysError("pread"));
+                break;
+            }
+            filled.push(s);
+        }
+        filled.close();
+    });
+
+    std::atomic<unsigned> active{workers};
+    std::thread crypto([&] {
+        pool.parallelFor(workers, [&](size_t) {
+            uint8_t nonce[12], aad[AAD_SIZE];
+            std::memcpy(nonce, iv, 8);
+            std::memcpy(aad, job.header, HEADER_SIZE);
+            while (Slot* s = filled.pop()) {
+                if (failed.load()) break;
+                uint64_t i = s->index;
+                size_t len = inLength(i);
+                const uint8_t* src = map ? map + job.inBase + i * job.inStride : s->buf.data();
+                uint8_t* dst = s->buf.data();
+                if (job.mode == CTR) {
+                    ctr.crypt(src, dst, len, i * job.chunk);
+                } else {
+                    storeBE32(uint32_t(i), nonce + 8);
+                    storeBE64(i, aad + HEADER_SIZE);
+                    aad[HEADER_SIZE + 8] = i + 1 == job.chunks;
+                    if (!job.decrypting) {
+                        gcm.encrypt(nonce, sizeof(nonce), aad, AAD_SIZE, src, dst, len, dst + len);
+                    } else if (!gcm.decrypt(nonce, sizeof(nonce), aad, AAD_SIZE, src, dst,
+                                            len - SM4_GCM::TAG_SIZE, src + len - SM4_GCM::TAG_SIZE)) {
+                        fail("authentication failed in chunk " + std::to_string(i));
+                        break;
+                    }
+                }
+                done.push(s);
+            }
+            if (active.fetch_sub(1) == 1) done.close();
+        });
+    });
+
+    // 写出在调用线程上进行
+    while (Slot* s = done.pop()) {
+        if (failed.load()) break;
+        uint64_t i = s->index;
+        size_t len = inLength(i);
+        if (job.mode == GCM) {
+            len = job.decrypting ? len - SM4_GCM::TAG_SIZE : len + SM4_GCM::TAG_SIZE;
+        }
+        if (!pwriteAll(job.outFd, s->buf.data(), len, job.outBase + i * job.outStride)) {
+            fail(sysError("pwrite"));
+            break;
+        }
+        freeSlots.push(s);
+    }
+
+    reader.join();
+    crypto.join();
+    if (map) ::munmap(map, mapLen);
+    for (auto& s : slots) secureZero(s.buf.data(), s.buf.size());
+
+    if (failed.load()) {
+        if (error) *error = err;
+        return false;
+    }
+    return true;
+}
+
+bool SM4FileCipher::encryptFile(const std::string& inPath, const std::string& outPath, std::string* error) const {
+    int in = ::open(inPath.c_str(), O_RDONLY);
+    if (in < 0) {
+        if (error) *error = sysError(inPath.c_str());
+        return false;
+    }
+    int out = ::open(outPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (out < 0) {
+        if (error) *error = sysError(outPath.c_str());
+        ::close(in);
+        return false;
+    }
+    bool ok = encrypt(in, out, error);
+    ::close(in);
+    if (::close(out) != 0 && ok) {
+        if (error) *error = sysError(outPath.c_str());
+        ok = false;
+    }
+    return ok;
+}
+
+bool SM4FileCipher::decryptFile(const std::string& inPath, const std::string& outPath, std::string* error) const {
+    int in = ::open(inPath.c_str(), O_RDONLY);
+    if (in < 0) {
+        if (error) *error = sysError(inPath.c_str());
+        return false;
+    }
+    int out = ::open(outPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (out < 0) {
+        if (error) *error = sysError(outPath.c_str());
+        ::close(in);
+        return false;
+    }
+    bool ok = decrypt(in, out, error);
+    ::close(in);
+    if (::close(out) != 0 && ok) {
+        if (error) *error = sysError(outPath.c_str());
+        ok = false;
+    }
+    return ok;
+}
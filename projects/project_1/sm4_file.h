@@ -0,0 +1,72 @@
+#ifndef SM4_FILE_H
+#define SM4_FILE_H
+
+#include "sm4.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * SM4FileCipher
+ * 大文件的流水线加解密，吞吐量受磁盘而不是密码运算或内存拷贝限制：
+ *   - 读取线程：输入文件整体 mmap（零拷贝，MADV_SEQUENTIAL 预读），或用 pread 按块读入；
+ *   - 工作线程：在全局线程池上并行加解密各块，块之间互不依赖；
+ *   - 写出线程：按块在输出文件中的固定偏移 pwrite，块可以乱序完成。
+ * 三个阶段通过 threads + 2 个块缓冲区轮转衔接，读下一块、加密当前块与写上一块同时进行。
+ *
+ * 输出格式：32 字节文件头 + 各块
+ *   文件头 = "SM4F" | 版本 1 | 模式 | 2 字节 0 | 块长（4 字节大端） | 16 字节随机 IV | 4 字节 0
+ *   CTR：第 i 块是明文字节偏移 i·块长处的 SM4_CTR(key, IV) 密文，总长度与明文相同；不提供完整性保护。
+ *   GCM：每块独立做 GCM，输出 密文 || 16 字节标签。
+ *        nonce = IV[0..7] || i（4 字节大端），AAD = 文件头 || i（8 字节大端）|| 末块标志，
+ *        交换、删除或截断块都会导致认证失败；空文件也输出一个空的末块。
+ *        nonce 的随机部分只有 IV 的前 8 字节：同一密钥加密 n 个文件时，某两个文件随机部分相同的概率约为
+ *        n² / 2^65，n 接近 2^32 时几乎必然相同；相同的 nonce 会泄露两块明文的异或并可伪造标签。
+ *        按 NIST SP 800-38D 对随机 nonce 的要求（碰撞概率不超过 2^-32），同一密钥至多加密约 2^16 个文件，
+ *        超过时应更换密钥。
+ *
+ * 解密从文件头读取模式与块长。GCM 解密失败时输出文件被截断为 0 字节，不留下未认证的明文。
+ * 所有接口返回 false 表示失败，error 非空时写入原因。
+ */
+class SM4FileCipher {
+public:
+    enum Mode : uint8_t { CTR = 1, GCM = 2 };
+
+    static constexpr size_t HEADER_SIZE = 32;
+    static constexpr size_t DEFAULT_CHUNK = 4 * 1024 * 1024;
+    // 块长上限：每个块缓冲区按块长分配，解密时块长来自未认证的文件头
+    static constexpr size_t MAX_CHUNK = 64 * 1024 * 1024;
+
+    /*
+     * @param key: 16 字节密钥
+     * @param mode: 加密模式（解密时以文件头为准）
+     * @param chunkSize: 块长，须为 16 的倍数且不超过 MAX_CHUNK
+     * @param threads: 工作线程数，0 表示全局线程池的全部线程
+     */
+    SM4FileCipher(const uint8_t key[16], Mode mode = GCM, size_t chunkSize = DEFAULT_CHUNK,
+                  unsigned threads = 0);
+    ~SM4FileCipher();
+
+    // 关闭 mmap，改用 pread 读入（例如输入在网络文件系统上）
+    void useMmap(bool enable) { mmapInput = enable; }
+
+    bool encryptFile(const std::string& inPath, const std::string& outPath, std::string* error = nullptr) const;
+    bool decryptFile(const std::string& inPath, const std::string& outPath, std::string* error = nullptr) const;
+
+    /* 文件描述符接口：inFd 须为普通文件，outFd 须可 pwrite 与 ftruncate */
+    bool encrypt(int inFd, int outFd, std::string* error = nullptr) const;
+    bool decrypt(int inFd, int outFd, std::string* error = nullptr) const;
+
+private:
+    struct Job;
+
+    bool run(const Job& job, std::string* error) const;
+
+    uint8_t key[16];
+    Mode mode;
+    size_t chunkSize;
+    unsigned threads;
+    bool mmapInput = true;
+};
+
+#endif // SM4_FILE_H
@@ -0,0 +1,343 @@
+#include "sm4_gcm.h"
+#include "sm4_engine.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SM4_GCM_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// 每段处理的分组数：密钥流与这一段密文都留在 L1 缓存中，随后立即做 GHASH
+constexpr size_t GCM_BATCH = 64;
+
+inline uint64_t loadBE64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return __builtin_bswap64(v);
+}
+
+inline void storeBE64(uint64_t v, uint8_t* p) {
+    v = __builtin_bswap64(v);
+    std::memcpy(p, &v, 8);
+}
+
+inline uint32_t loadBE32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return __builtin_bswap32(v);
+}
+
+inline void storeBE32(uint32_t v, uint8_t* p) {
+    v = __builtin_bswap32(v);
+    std::memcpy(p, &v, 4);
+}
+
+/* ---------------- 查表 GHASH（Shoup 4 位表） ---------------- */
+
+/*
+ * GCM 的域元素按“反射”位序表示：第 0 字节的最高位是 x^0 的系数。
+ * 乘以 x 即整体右移一位，移出的位按 x^128 = x^7 + x^2 + x + 1 折回（0xE1 << 120）。
+ * REM_4BIT[r] 是一次右移 4 位时移出的半字节 r 折回高 16 位的值。
+ */
+const uint64_t REM_4BIT[16] = {
+    0x0000ULL << 48, 0x1C20ULL << 48, 0x3840ULL << 48, 0x2460ULL << 48,
+    0x7080ULL << 48, 0x6CA0ULL << 48, 0x48C0ULL << 48, 0x54E0ULL << 48,
+    0xE100ULL << 48, 0xFD20ULL << 48, 0xD940ULL << 48, 0xC560ULL << 48,
+    0x9180ULL << 48, 0x8DA0ULL << 48, 0xA9C0ULL << 48, 0xB5E0ULL << 48
+};
+
+void tableInit(const uint8_t h[16], uint64_t t[16][2]) {
+    uint64_t hi = loadBE64(h), lo = loadBE64(h + 8);
+    t[0][0] = t[0][1] = 0;
+    // t[8] = H，t[4] = H·x，t[2] = H·x^2，t[1] = H·x^3（半字节最高位对应 x^0）
+    for (int i = 8; i > 0; i >>= 1) {
+        t[i][0] = hi;
+        t[i][1] = lo;
+        uint64_t r = 0xE100000000000000ULL & (0 - (lo & 1));
+        lo = (hi << 63) | (lo >> 1);
+        hi = (hi >> 1) ^ r;
+    }
+    for (int i = 2; i < 16; i <<= 1) {
+        for (int j = 1; j < i; ++j) {
+            t[i + j][0] = t[i][0] ^ t[j][0];
+            t[i + j][1] = t[i][1] ^ t[j][1];
+        }
+    }
+}
+
+/* y = y·H：从最后一个字节的低半字节开始，每步右移 4 位再累加 t[nibble] */
+void tableMul(uint8_t y[16], const uint64_t t[16][2]) {
+    uint64_t zh = 0, zl = 0;
+    for (int i = 15; i >= 0; --i) {
+        for (int shift = 0; shift <= 4; shift += 4) {
+            unsigned nib = (y[i] >> shift) & 0x0F;
+            unsigned rem = unsigned(zl & 0x0F);
+            zl = (zh << 60) | (zl >> 4);
+            zh = (zh >> 4) ^ REM_4BIT[rem];
+            zh ^= t[nib][0];
+            zl ^= t[nib][1];
+        }
+    }
+    storeBE64(zh, y);
+    storeBE64(zl, y + 8);
+}
+
+void tableGhash(const uint64_t t[16][2], uint8_t y[16], const uint8_t* data, size_t nblocks) {
+    for (; nblocks; --nblocks, data += 16) {
+        for (int i = 0; i < 16; ++i) y[i] ^= data[i];
+        tableMul(y, t);
+    }
+}
+
+#ifdef SM4_GCM_X86
+
+/* ---------------- PCLMULQDQ GHASH ---------------- */
+
+#define SM4_CLMUL __attribute__((target("pclmul,ssse3")))
+
+/*
+ * 分组整体字节逆序后，域元素的 x^0..x^127 恰好落在寄存器的第 127..0 位。
+ * 两个这样的 128 位数做普通无进位乘法，得到的 255 位积相对真实结果差一个左移 1 位，
+ * 在约减前补上（Gueron & Kounavis，Intel 白皮书算法 5）。
+ */
+SM4_CLMUL inline __m128i byteReverse(__m128i x) {
+    return _mm_shuffle_epi8(x, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+/* 未约减的 256 位积 hi:lo，可以跨分组直接异或累加 */
+SM4_CLMUL inline void clmul(__m128i a, __m128i b, __m128i& lo, __m128i& hi) {
+    __m128i mid = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+    lo = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x00), _mm_slli_si128(mid, 8));
+    hi = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x11), _mm_srli_si128(mid, 8));
+}
+
+/* 左移 1 位后按 x^128 + x^7 + x^2 + x + 1 约减到 128 位 */
+SM4_CLMUL inline __m128i reduce(__m128i lo, __m128i hi) {
+    __m128i c0 = _mm_srli_epi32(lo, 31);
+    __m128i c1 = _mm_srli_epi32(hi, 31);
+    lo = _mm_slli_epi32(lo, 1);
+    hi = _mm_slli_epi32(hi, 1);
+    hi = _mm_or_si128(hi, _mm_srli_si128(c0, 12));
+    hi = _mm_or_si128(hi, _mm_slli_si128(c1, 4));
+    lo = _mm_or_si128(lo, _mm_slli_si128(c0, 4));
+
+    __m128i a = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30)),
+                              _mm_slli_epi32(lo, 25));
+    __m128i carry = _mm_srli_si128(a, 4);
+    lo = _mm_xor_si128(lo, _mm_slli_si128(a, 12));
+
+    __m128i b = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2)),
+                              _mm_srli_epi32(lo, 7));
+    b = _mm_xor_si128(b, carry);
+    return _mm_xor_si128(hi, _mm_xor_si128(lo, b));
+}
+
+SM4_CLMUL inline __m128i gfmul(__m128i a, __m128i b) {
+    __m128i lo, hi;
+    clmul(a, b, lo, hi);
+    return reduce(lo, hi);
+}
+
+SM4_CLMUL void clmulInit(const uint8_t h[16], uint8_t pow[8][16]) {
+    __m128i h1 = byteReverse(_mm_loadu_si128(reinterpret_cast<const __m128i*>(h)));
+    __m128i p = h1;
+    for (int i = 0; i < 8; ++i) {
+        _mm_store_si128(reinterpret_cast<__m128i*>(pow[i]), p);
+        p = gfmul(p, h1);
+    }
+}
+
+/*
+ * 聚合约减：8 个分组一组，
+ *     y' = (y ^ X1)·H^8 ^ X2·H^7 ^ ... ^ X8·H
+ * 8 个乘积先以 256 位形式异或累加，最后只约减一次
+ */
+SM4_CLMUL void clmulGhash(const uint8_t pow[8][16], uint8_t y[16], const uint8_t* data, size_t nblocks) {
+    const __m128i* hp = reinterpret_cast<const __m128i*>(pow);
+    __m128i acc = byteReverse(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y)));
+
+    if (nblocks >= 8) {
+        const __m128i h1 = _mm_load_si128(hp + 0), h2 = _mm_load_si128(hp + 1);
+        const __m128i h3 = _mm_load_si128(hp + 2), h4 = _mm_load_si128(hp + 3);
+        const __m128i h5 = _mm_load_si128(hp + 4), h6 = _mm_load_si128(hp + 5);
+        const __m128i h7 = _mm_load_si128(hp + 6), h8 = _mm_load_si128(hp + 7);
+        for (; nblocks >= 8; nblocks -= 8, data += 128) {
+            const __m128i* p = reinterpret_cast<const __m128i*>(data);
+            __m128i lo, hi, l, h;
+            clmul(_mm_xor_si128(acc, byteReverse(_mm_loadu_si128(p))), h8, lo, hi);
+            clmul(byteReverse(_mm_loadu_si128(p + 1)), h7, l, h);
+            lo = _mm_xor_si128(lo, l); hi = _mm_xor_si128(hi, h);
+            clmul(byteReverse(_mm_loadu_si128(p + 2)), h6, l, h);
+            lo = _mm_xor_si128(lo, l); hi = _mm_xor_si128(hi, h);
+            clmul(byteReverse(_mm_loadu_si128(p + 3)), h5, l, h);
+            lo = _mm_xor_si128(lo, l); hi = _mm_xor_si128(hi, h);
+            clmul(byteReverse(_mm_loadu_si128(p + 4)), h4, l, h);
+            lo = _mm_xor_si128(lo, l); hi = _mm_xor_si128(hi, h);
+            clmul(byteReverse(_mm_loadu_si128(p + 5)), h3, l, h);
+            lo = _mm_xor_si128(lo, l); hi = _mm_xor_si128(hi, h);
+            clmul(byteReverse(_mm_loadu_si128(p + 6)), h2, l, h);
+            lo = _mm_xor_si128(lo, l); hi = _mm_xor_si128(hi, h);
+            clmul(byteReverse(_mm_loadu_si128(p + 7)), h1, l, h);
+            lo = _mm_xor_si128(lo, l); hi = _mm_xor_si128(hi, h);
+            acc = reduce(lo, hi);
+        }
+    }
+
+    const __m128i h1 = _mm_load_si128(hp);
+    for (; nblocks; --nblocks, data += 16) {
+        acc = _mm_xor_si128(acc, byteReverse(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data))));
+        acc = gfmul(acc, h1);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(y), byteReverse(acc));
+}
+
+#endif // SM4_GCM_X86
+
+} // namespace
+
+#ifdef SM4_GCM_X86
+bool SM4_GCM::hasPCLMUL() {
+    static const bool ok = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+    return ok;
+}
+#else
+bool SM4_GCM::hasPCLMUL() { return false; }
+#endif
+
+SM4_GCM::SM4_GCM(const uint8_t key[16], SM4BlocksFn blocks)
+    : blocks(blocks ? blocks : SM4Engine::blocks()), clmul(SM4Engine::ghashClmul()) {
+    SM4::keyGenerate(key, key_r);
+
+    // 散列子密钥 H = E(K, 0^128)
+    uint8_t h[16] = {0};
+    this->blocks(key_r, h, h, 1);
+    tableInit(h, hTable);
+#ifdef SM4_GCM_X86
+    if (clmul) clmulInit(h, hPow);
+#endif
+}
+
+SM4_GCM::SM4_GCM(const std::vector<unsigned char>& key, SM4BlocksFn blocks)
+    : SM4_GCM(key.data(), blocks) {}
+
+void SM4_GCM::ghash(uint8_t y[16], const uint8_t* data, size_t nblocks) const {
+#ifdef SM4_GCM_X86
+    if (clmul) {
+        clmulGhash(hPow, y, data, nblocks);
+        return;
+    }
+#endif
+    tableGhash(hTable, y, data, nblocks);
+}
+
+/* 末尾不足一个分组时补零 */
+void SM4_GCM::ghashPadded(uint8_t y[16], const uint8_t* data, size_t len) const {
+    size_t full = len / SM4::BLOCK_SIZE;
+    ghash(y, data, full);
+    size_t rest = len % SM4::BLOCK_SIZE;
+    if (rest) {
+        uint8_t last[16] = {0};
+        std::memcpy(last, data + full * SM4::BLOCK_SIZE, rest);
+        ghash(y, last, 1);
+    }
+}
+
+/* 96 位 IV：J0 = IV || 0^31 || 1；其他长度：J0 = GHASH(IV || 0 填充 || 0^64 || [len(IV)]_64) */
+void SM4_GCM::computeJ0(const uint8_t* iv, size_t ivLen, uint8_t j0[16]) const {
+    if (ivLen == 12) {
+        std::memcpy(j0, iv, 12);
+        storeBE32(1, j0 + 12);
+        return;
+    }
+    std::memset(j0, 0, 16);
+    ghashPadded(j0, iv, ivLen);
+    uint8_t lenBlock[16] = {0};
+    storeBE64(uint64_t(ivLen) * 8, lenBlock + 8);
+    ghash(j0, lenBlock, 1);
+}
+
+/* T = E(K, J0) ^ GHASH(A, C, [len(A)]_64 || [len(C)]_64) */
+void SM4_GCM::finishTag(uint8_t y[16], const uint8_t j0[16], size_t aadLen, size_t len,
+                        uint8_t tag[16]) const {
+    uint8_t lenBlock[16];
+    storeBE64(uint64_t(aadLen) * 8, lenBlock);
+    storeBE64(uint64_t(len) * 8, lenBlock + 8);
+    ghash(y, lenBlock, 1);
+
+    uint8_t ek[16];
+    blocks(key_r, j0, ek, 1);
+    for (int i = 0; i < 16; ++i) tag[i] = ek[i] ^ y[i];
+}
+
+/* GCM 的计数器只递增低 32 位（inc32），len 不超过 GCM_BATCH 个分组 */
+void SM4_GCM::ctr32(uint8_t ctr[16], const uint8_t* in, uint8_t* out, size_t len) const {
+    alignas(64) uint8_t ks[GCM_BATCH * SM4::BLOCK_SIZE];
+    size_t nblocks = (len + SM4::BLOCK_SIZE - 1) / SM4::BLOCK_SIZE;
+    uint32_t c = loadBE32(ctr + 12);
+    for (size_t i = 0; i < nblocks; ++i) {
+        std::memcpy(ks + i * SM4::BLOCK_SIZE, ctr, 12);
+        storeBE32(c++, ks + i * SM4::BLOCK_SIZE + 12);
+    }
+    storeBE32(c, ctr + 12);
+    blocks(key_r, ks, ks, nblocks);
+
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t a, k;
+        std::memcpy(&a, in + i, 8);
+        std::memcpy(&k, ks + i, 8);
+        a ^= k;
+        std::memcpy(out + i, &a, 8);
+    }
+    for (; i < len; ++i) out[i] = in[i] ^ ks[i];
+}
+
+void SM4_GCM::encrypt(const uint8_t* iv, size_t ivLen, const uint8_t* aad, size_t aadLen,
+                      const uint8_t* in, uint8_t* out, size_t len, uint8_t tag[TAG_SIZE]) const {
+    uint8_t j0[16], ctr[16], y[16] = {0};
+    computeJ0(iv, ivLen, j0);
+    std::memcpy(ctr, j0, 16);
+    storeBE32(loadBE32(j0 + 12) + 1, ctr + 12);
+
+    ghashPadded(y, aad, aadLen);
+    // 单遍：加密一段后立即对这段密文做 GHASH
+    for (size_t done = 0; done < len;) {
+        size_t n = std::min(len - done, GCM_BATCH * SM4::BLOCK_SIZE);
+        ctr32(ctr, in + done, out + done, n);
+        ghashPadded(y, out + done, n);
+        done += n;
+    }
+    finishTag(y, j0, aadLen, len, tag);
+}
+
+bool SM4_GCM::decrypt(const uint8_t* iv, size_t ivLen, const uint8_t* aad, size_t aadLen,
+                      const uint8_t* in, uint8_t* out, size_t len, const uint8_t tag[TAG_SIZE]) const {
+    uint8_t j0[16], ctr[16], y[16] = {0};
+    computeJ0(iv, ivLen, j0);
+    std::memcpy(ctr, j0, 16);
+    storeBE32(loadBE32(j0 + 12) + 1, ctr + 12);
+
+    ghashPadded(y, aad, aadLen);
+    // 先对密文段做 GHASH 再解密，in 与 out 相同时也不会读到明文
+    for (size_t done = 0; done < len;) {
+        size_t n = std::min(len - done, GCM_BATCH * SM4::BLOCK_SIZE);
+        ghashPadded(y, in + done, n);
+        ctr32(ctr, in + done, out + done, n);
+        done += n;
+    }
+
+    uint8_t expect[16];
+    finishTag(y, j0, aadLen, len, expect);
+
+    // 恒定时间比较
+    uint8_t diff = 0;
+    for (int i = 0; i < 16; ++i) diff |= uint8_t(expect[i] ^ tag[i]);
+    if (diff) {
+        if (len) std::memset(out, 0, len);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,72 @@
+#ifndef SM4_GCM_H
+#define SM4_GCM_H
+
+#include "sm4.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * SM4_GCM
+ * SM4 的 GCM 认证加密（NIST SP 800-38D，GB/T 36624-2018，RFC 8998）。
+ *
+ * 加解密与认证在同一遍内存访问中完成：数据按 64 个分组一段处理，
+ * 每段先批量生成 CTR 密钥流并异或，紧接着趁数据还在 L1 缓存中对密文做 GHASH。
+ *
+ * GHASH 有两个后端：
+ *   - PCLMULQDQ：无进位乘法，预计算 H^1..H^8，每 8 个分组只做一次模约减（聚合约减）；
+ *   - 查表：Shoup 4 位表（16 项 H 的倍数），用于不支持 PCLMULQDQ 的 CPU。
+ *     查表后端的访存地址依赖数据，不是恒定时间的。
+ */
+class SM4_GCM {
+public:
+    static constexpr size_t TAG_SIZE = 16;
+
+    /*
+     * @param key: 16 字节密钥
+     * @param blocks: 批量分组内核，默认 SM4Engine::blocks()（按 CPU 自动选择）
+     */
+    explicit SM4_GCM(const uint8_t key[16], SM4BlocksFn blocks = nullptr);
+    explicit SM4_GCM(const std::vector<unsigned char>& key, SM4BlocksFn blocks = nullptr);
+
+    /*
+     * 认证加密：in 与 out 可以相同
+     * @param iv / ivLen: 初始向量，推荐 12 字节
+     * @param aad / aadLen: 附加认证数据（只认证不加密）
+     * @param tag: 输出 16 字节认证标签
+     */
+    void encrypt(const uint8_t* iv, size_t ivLen, const uint8_t* aad, size_t aadLen,
+                 const uint8_t* in, uint8_t* out, size_t len, uint8_t tag[TAG_SIZE]) const;
+
+    /*
+     * 认证解密：标签校验失败时返回 false，并把 out 清零，不泄露未认证的明文
+     */
+    bool decrypt(const uint8_t* iv, size_t ivLen, const uint8_t* aad, size_t aadLen,
+                 const uint8_t* in, uint8_t* out, size_t len, const uint8_t tag[TAG_SIZE]) const;
+
+    // 选择 GHASH 后端；默认由 SM4Engine::ghashClmul() 决定（支持 PCLMULQDQ 时使用无进位乘法）
+    void useClmul(bool enable) { clmul = enable && hasPCLMUL(); }
+    bool usingClmul() const { return clmul; }
+    static bool hasPCLMUL();
+
+    /* GHASH：y = (y ^ data_1)·H ^ ... 依次吸收 nblocks 个完整分组 */
+    void ghash(uint8_t y[16], const uint8_t* data, size_t nblocks) const;
+
+private:
+    uint32_t key_r[32];
+    SM4BlocksFn blocks;
+    bool clmul;
+
+    alignas(16) uint8_t hPow[8][16]; // H^1..H^8，字节逆序后供 PCLMULQDQ 使用
+    uint64_t hTable[16][2];          // Shoup 4 位表：hTable[i] = i·H（高/低 64 位）
+
+    // 计算 J0 与 GHASH 长度、标签等公共步骤
+    void computeJ0(const uint8_t* iv, size_t ivLen, uint8_t j0[16]) const;
+    void ghashPadded(uint8_t y[16], const uint8_t* data, size_t len) const;
+    void finishTag(uint8_t y[16], const uint8_t j0[16], size_t aadLen, size_t len, uint8_t tag[16]) const;
+
+    // 一段数据的 CTR 异或（计数器低 32 位递增）
+    void ctr32(uint8_t ctr[16], const uint8_t* in, uint8_t* out, size_t len) const;
+};
+
+#endif // SM4_GCM_H
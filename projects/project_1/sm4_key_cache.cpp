@@ -0,0 +1,119 @@
+#include "sm4_key_cache.h"
+#include <cstring>
+#include <random>
+
+namespace {
+
+// 擦除密钥材料，volatile 写防止被编译器当作死存储优化掉
+void secureZero(void* p, size_t n) {
+    volatile uint8_t* v = static_cast<volatile uint8_t*>(p);
+    while (n--) *v++ = 0;
+}
+
+uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// 每个进程随机的盐值，使指纹不可预测，避免针对散列表的碰撞攻击
+struct Salt {
+    uint64_t a, b;
+
+    Salt() {
+        std::random_device rd;
+        a = (uint64_t(rd()) << 32) | rd();
+        b = (uint64_t(rd()) << 32) | rd();
+    }
+};
+
+const Salt& salt() {
+    static const Salt s;
+    return s;
+}
+
+} // namespace
+
+uint64_t SM4KeyCache::fingerprint(const uint8_t key[16]) {
+    uint64_t k0, k1;
+    std::memcpy(&k0, key, 8);
+    std::memcpy(&k1, key + 8, 8);
+    const Salt& s = salt();
+    return mix64(mix64(k0 ^ s.a) ^ k1 ^ s.b);
+}
+
+SM4KeyCache::SM4KeyCache(size_t capacity)
+    : cap(capacity) {}
+
+SM4KeyCache::~SM4KeyCache() {
+    clear();
+}
+
+void SM4KeyCache::evictOldest() {
+    Entry& e = lru.back();
+    index.erase(fingerprint(e.key));
+    secureZero(&e, sizeof(e));
+    lru.pop_back();
+}
+
+bool SM4KeyCache::get(const uint8_t key[16], SM4Context& ctx) {
+    const uint64_t fp = fingerprint(key);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = index.find(fp);
+        if (it != index.end() && std::memcmp(it->second->key, key, 16) == 0) {
+            lru.splice(lru.begin(), lru, it->second);
+            ctx = it->second->ctx;
+            ++hitCount;
+            return true;
+        }
+        ++missCount;
+    }
+
+    // 密钥拓展在锁外进行，不阻塞其他线程的命中查询
+    SM4::initContext(key, ctx);
+    if (cap == 0) return false;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = index.find(fp);
+    if (it != index.end()) {
+        // 其他线程已插入同一密钥，或指纹碰撞：覆盖旧项
+        std::memcpy(it->second->key, key, 16);
+        it->second->ctx = ctx;
+        lru.splice(lru.begin(), lru, it->second);
+        return false;
+    }
+    if (lru.size() >= cap) evictOldest();
+    Entry e;
+    std::memcpy(e.key, key, 16);
+    e.ctx = ctx;
+    lru.push_front(e);
+    secureZero(&e, sizeof(e));
+    index[fp] = lru.begin();
+    return false;
+}
+
+size_t SM4KeyCache::size() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return lru.size();
+}
+
+uint64_t SM4KeyCache::hits() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return hitCount;
+}
+
+uint64_t SM4KeyCache::misses() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return missCount;
+}
+
+void SM4KeyCache::clear() {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (Entry& e : lru) secureZero(&e, sizeof(e));
+    lru.clear();
+    index.clear();
+}
@@ -0,0 +1,59 @@
+#ifndef SM4_KEY_CACHE_H
+#define SM4_KEY_CACHE_H
+
+#include "sm4.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+/*
+ * SM4KeyCache
+ * 有界的 LRU 缓存，保存已展开的密钥上下文（加密与逆序的解密轮密钥），
+ * 适合会话密钥频繁切换、单条消息很短、密钥拓展占比高的场景。
+ *
+ * 以密钥指纹（加盐的 64 位散列，盐值每个进程随机生成）为索引，命中后再比较完整密钥，
+ * 指纹碰撞只会导致未命中，不会返回错误的轮密钥。
+ * 缓存中的轮密钥与密钥等价，被淘汰或清空时会擦除。所有操作加锁，可多线程共享。
+ */
+class SM4KeyCache {
+public:
+    explicit SM4KeyCache(size_t capacity = 1024);
+    ~SM4KeyCache();
+
+    SM4KeyCache(const SM4KeyCache&) = delete;
+    SM4KeyCache& operator=(const SM4KeyCache&) = delete;
+
+    /*
+     * 取得 key 对应的上下文：命中时拷贝缓存内容，未命中时展开并插入（必要时淘汰最久未用的项）
+     * @return 是否命中
+     */
+    bool get(const uint8_t key[16], SM4Context& ctx);
+
+    size_t size() const;
+    size_t capacity() const { return cap; }
+    uint64_t hits() const;
+    uint64_t misses() const;
+    void clear();
+
+    /* 密钥指纹 */
+    static uint64_t fingerprint(const uint8_t key[16]);
+
+private:
+    struct Entry {
+        uint8_t key[16];
+        SM4Context ctx;
+    };
+
+    void evictOldest();
+
+    size_t cap;
+    mutable std::mutex mtx;
+    std::list<Entry> lru; // 表头为最近使用
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    uint64_t hitCount = 0;
+    uint64_t missCount = 0;
+};
+
+#endif // SM4_KEY_CACHE_H
@@ -0,0 +1,204 @@
+#include "sm4_modes.h"
+#include "sm4_engine.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 解密时每次交给批量内核的分组数：调用者自带的内核按 16 个一批，表中的后端按各自的宽度，至多 256 个
+constexpr size_t MODE_BATCH = 16;
+constexpr size_t MODE_BATCH_MAX = 256;
+
+// 串行链用的单分组内核：表中的后端取同一族的 serial，调用者自带的内核原样使用
+SM4BlocksFn serialFor(SM4BlocksFn blocks) {
+    const SM4Engine::Backend* b = SM4Engine::find(blocks);
+    return b ? b->serial : blocks;
+}
+
+size_t batchFor(SM4BlocksFn blocks) {
+    const SM4Engine::Backend* b = SM4Engine::find(blocks);
+    return b ? std::min(b->batch, MODE_BATCH_MAX) : MODE_BATCH;
+}
+
+inline void xor16(const uint8_t* a, const uint8_t* b, uint8_t* out) {
+    uint64_t a0, a1, b0, b1;
+    std::memcpy(&a0, a, 8);
+    std::memcpy(&a1, a + 8, 8);
+    std::memcpy(&b0, b, 8);
+    std::memcpy(&b1, b + 8, 8);
+    a0 ^= b0;
+    a1 ^= b1;
+    std::memcpy(out, &a0, 8);
+    std::memcpy(out + 8, &a1, 8);
+}
+
+} // namespace
+
+/* ---------------- PKCS#7 ---------------- */
+
+std::vector<unsigned char> PKCS7::pad(const uint8_t* data, size_t len) {
+    size_t n = SM4::BLOCK_SIZE - len % SM4::BLOCK_SIZE;
+    std::vector<unsigned char> out(len + n, static_cast<unsigned char>(n));
+    if (len) std::memcpy(out.data(), data, len);
+    return out;
+}
+
+bool PKCS7::unpad(std::vector<unsigned char>& data) {
+    size_t len = data.size();
+    if (len == 0 || len % SM4::BLOCK_SIZE) return false;
+
+    unsigned n = data[len - 1];
+    unsigned bad = (n == 0) | (n > SM4::BLOCK_SIZE);
+    // 总是检查最后 16 个字节，耗时与填充长度无关
+    for (unsigned i = 0; i < SM4::BLOCK_SIZE; ++i) {
+        unsigned inPad = i < n;
+        bad |= inPad & (data[len - 1 - i] != n);
+    }
+    if (bad) return false;
+    data.resize(len - n);
+    return true;
+}
+
+/* ---------------- CBC ---------------- */
+
+SM4_CBC::SM4_CBC(const uint8_t key[16], SM4BlocksFn blocks)
+    : blocks(blocks ? blocks : SM4Engine::blocks()), serial(serialFor(this->blocks)), batch(batchFor(this->blocks)) {
+    SM4::initContext(key, ctx);
+}
+
+SM4_CBC::SM4_CBC(const std::vector<unsigned char>& key, SM4BlocksFn blocks)
+    : SM4_CBC(key.data(), blocks) {}
+
+void SM4_CBC::encrypt(uint8_t iv[16], const uint8_t* in, uint8_t* out, size_t nblocks) const {
+    uint8_t x[16];
+    std::memcpy(x, iv, 16);
+    for (; nblocks; --nblocks, in += 16, out += 16) {
+        xor16(x, in, x);
+        serial(ctx.rk_enc, x, x, 1);
+        std::memcpy(out, x, 16);
+    }
+    std::memcpy(iv, x, 16);
+}
+
+void SM4_CBC::decrypt(uint8_t iv[16], const uint8_t* in, uint8_t* out, size_t nblocks) const {
+    alignas(64) uint8_t buf[MODE_BATCH_MAX * SM4::BLOCK_SIZE];
+    uint8_t prev[16], c[16];
+    std::memcpy(prev, iv, 16);
+
+    while (nblocks) {
+        size_t n = std::min(nblocks, batch);
+        blocks(ctx.rk_dec, in, buf, n);
+        // 原地解密时 out 会覆盖 in，先保存本分组密文作为下一分组的链接值
+        for (size_t i = 0; i < n; ++i) {
+            std::memcpy(c, in + i * 16, 16);
+            xor16(buf + i * 16, prev, out + i * 16);
+            std::memcpy(prev, c, 16);
+        }
+        in += n * 16;
+        out += n * 16;
+        nblocks -= n;
+    }
+    std::memcpy(iv, prev, 16);
+}
+
+std::vector<unsigned char> SM4_CBC::encryptPadded(const uint8_t iv[16],
+                                                  const std::vector<unsigned char>& plaintext) const {
+    std::vector<unsigned char> out = PKCS7::pad(plaintext.data(), plaintext.size());
+    uint8_t chain[16];
+    std::memcpy(chain, iv, 16);
+    encrypt(chain, out.data(), out.data(), out.size() / SM4::BLOCK_SIZE);
+    return out;
+}
+
+bool SM4_CBC::decryptPadded(const uint8_t iv[16], const std::vector<unsigned char>& ciphertext,
+                            std::vector<unsigned char>& plaintext) const {
+    if (ciphertext.empty() || ciphertext.size() % SM4::BLOCK_SIZE) return false;
+    plaintext.resize(ciphertext.size());
+    uint8_t chain[16];
+    std::memcpy(chain, iv, 16);
+    decrypt(chain, ciphertext.data(), plaintext.data(), ciphertext.size() / SM4::BLOCK_SIZE);
+    if (!PKCS7::unpad(plaintext)) {
+        plaintext.clear();
+        return false;
+    }
+    return true;
+}
+
+/* ---------------- CFB ---------------- */
+
+SM4_CFB::SM4_CFB(const uint8_t key[16], SM4BlocksFn blocks)
+    : blocks(blocks ? blocks : SM4Engine::blocks()), serial(serialFor(this->blocks)), batch(batchFor(this->blocks)) {
+    SM4::keyGenerate(key, key_r);
+}
+
+SM4_CFB::SM4_CFB(const std::vector<unsigned char>& key, SM4BlocksFn blocks)
+    : SM4_CFB(key.data(), blocks) {}
+
+void SM4_CFB::encrypt(uint8_t iv[16], const uint8_t* in, uint8_t* out, size_t len) const {
+    uint8_t x[16];
+    std::memcpy(x, iv, 16);
+    for (; len >= 16; len -= 16, in += 16, out += 16) {
+        serial(key_r, x, x, 1);
+        xor16(x, in, x);
+        std::memcpy(out, x, 16);
+    }
+    std::memcpy(iv, x, 16);
+    if (len) {
+        serial(key_r, x, x, 1);
+        for (size_t i = 0; i < len; ++i) out[i] = in[i] ^ x[i];
+    }
+}
+
+void SM4_CFB::decrypt(uint8_t iv[16], const uint8_t* in, uint8_t* out, size_t len) const {
+    alignas(64) uint8_t buf[MODE_BATCH_MAX * SM4::BLOCK_SIZE];
+    uint8_t prev[16];
+    std::memcpy(prev, iv, 16);
+
+    size_t nblocks = len / SM4::BLOCK_SIZE;
+    while (nblocks) {
+        size_t n = std::min(nblocks, batch);
+        // 批量内核的输入：C_{i-1}，即 IV 与本批前 n-1 个密文分组
+        std::memcpy(buf, prev, 16);
+        std::memcpy(buf + 16, in, (n - 1) * 16);
+        std::memcpy(prev, in + (n - 1) * 16, 16);
+        blocks(key_r, buf, buf, n);
+        for (size_t i = 0; i < n; ++i) {
+            xor16(in + i * 16, buf + i * 16, out + i * 16);
+        }
+        in += n * 16;
+        out += n * 16;
+        nblocks -= n;
+    }
+    std::memcpy(iv, prev, 16);
+
+    len %= SM4::BLOCK_SIZE;
+    if (len) {
+        uint8_t ks[16];
+        serial(key_r, prev, ks, 1);
+        for (size_t i = 0; i < len; ++i) out[i] = in[i] ^ ks[i];
+    }
+}
+
+/* ---------------- OFB ---------------- */
+
+SM4_OFB::SM4_OFB(const uint8_t key[16], SM4BlocksFn blocks)
+    : serial(serialFor(blocks ? blocks : SM4Engine::blocks())) {
+    SM4::keyGenerate(key, key_r);
+}
+
+SM4_OFB::SM4_OFB(const std::vector<unsigned char>& key, SM4BlocksFn blocks)
+    : SM4_OFB(key.data(), blocks) {}
+
+void SM4_OFB::crypt(uint8_t iv[16], const uint8_t* in, uint8_t* out, size_t len) const {
+    uint8_t x[16];
+    std::memcpy(x, iv, 16);
+    for (; len >= 16; len -= 16, in += 16, out += 16) {
+        serial(key_r, x, x, 1);
+        xor16(x, in, out);
+    }
+    if (len) {
+        serial(key_r, x, x, 1);
+        for (size_t i = 0; i < len; ++i) out[i] = in[i] ^ x[i];
+    }
+    std::memcpy(iv, x, 16);
+}
@@ -0,0 +1,96 @@
+#ifndef SM4_MODES_H
+#define SM4_MODES_H
+
+#include "sm4.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * PKCS#7 填充：补 n 个值为 n 的字节（1 <= n <= 16），整分组明文也补一个完整分组
+ */
+class PKCS7 {
+public:
+    static std::vector<unsigned char> pad(const uint8_t* data, size_t len);
+
+    /*
+     * 校验并去除填充：data 长度必须是分组整数倍
+     * 校验过程不因填充内容提前退出，失败时返回 false 且不修改 data
+     */
+    static bool unpad(std::vector<unsigned char>& data);
+};
+
+/*
+ * SM4_CBC
+ * C_i = E(P_i ^ C_{i-1})，C_{-1} = IV
+ *   - 加密必须逐分组串行，每个分组交给所选后端同一族的单分组内核（SM4Engine::Backend::serial），
+ *     不补齐到批量内核的宽度；恒定时间后端与 SM4_BACKEND 覆盖同样生效，只有 T 表后端才是查表实现；
+ *   - 解密 P_i = D(C_i) ^ C_{i-1} 的各分组互不依赖，按批量内核的宽度分批（位切片 256 个，其余 16 个）。
+ * 调用者自带的内核不在后端表中，串行链与批量解密都直接使用它，批量解密 16 个一批。
+ * 原始接口只处理整分组，iv 为输入输出参数：返回时是最后一个密文分组，可直接接着处理下一段。
+ * in 与 out 可以相同（原地加解密）。
+ */
+class SM4_CBC {
+public:
+    /*
+     * @param key: 16 字节密钥
+     * @param blocks: 分组内核，默认 SM4Engine::blocks()（按 CPU 自动选择）
+     */
+    explicit SM4_CBC(const uint8_t key[16], SM4BlocksFn blocks = nullptr);
+    explicit SM4_CBC(const std::vector<unsigned char>& key, SM4BlocksFn blocks = nullptr);
+
+    void encrypt(uint8_t iv[16], const uint8_t* in, uint8_t* out, size_t nblocks) const;
+    void decrypt(uint8_t iv[16], const uint8_t* in, uint8_t* out, size_t nblocks) const;
+
+    /* 带 PKCS#7 填充的整条消息加解密；解密时填充错误或长度非法返回 false */
+    std::vector<unsigned char> encryptPadded(const uint8_t iv[16], const std::vector<unsigned char>& plaintext) const;
+    bool decryptPadded(const uint8_t iv[16], const std::vector<unsigned char>& ciphertext,
+                       std::vector<unsigned char>& plaintext) const;
+
+private:
+    SM4Context ctx; // 加密与逆序的解密轮密钥
+    SM4BlocksFn blocks;
+    SM4BlocksFn serial;
+    size_t batch;
+};
+
+/*
+ * SM4_CFB（128 位反馈，与 OpenSSL sm4-cfb 一致）
+ * C_i = P_i ^ E(C_{i-1})
+ *   - 加密串行，使用单分组内核，同 SM4_CBC；
+ *   - 解密时 E(C_{i-1}) 的输入全是已知密文，按批量内核的宽度分批并行生成。
+ * len 可以不是分组整数倍；此时本次调用视为消息结尾，iv 不再可用于续接。
+ */
+class SM4_CFB {
+public:
+    explicit SM4_CFB(const uint8_t key[16], SM4BlocksFn blocks = nullptr);
+    explicit SM4_CFB(const std::vector<unsigned char>& key, SM4BlocksFn blocks = nullptr);
+
+    void encrypt(uint8_t iv[16], const uint8_t* in, uint8_t* out, size_t len) const;
+    void decrypt(uint8_t iv[16], const uint8_t* in, uint8_t* out, size_t len) const;
+
+private:
+    uint32_t key_r[32];
+    SM4BlocksFn blocks;
+    SM4BlocksFn serial;
+    size_t batch;
+};
+
+/*
+ * SM4_OFB（与 OpenSSL sm4-ofb 一致）
+ * O_i = E(O_{i-1})，C_i = P_i ^ O_i，加密与解密是同一个操作。
+ * 密钥流是一条串行链，无法按分组并行，每个分组交给单分组内核，同 SM4_CBC。
+ */
+class SM4_OFB {
+public:
+    explicit SM4_OFB(const uint8_t key[16], SM4BlocksFn blocks = nullptr);
+    explicit SM4_OFB(const std::vector<unsigned char>& key, SM4BlocksFn blocks = nullptr);
+
+    void crypt(uint8_t iv[16], const uint8_t* in, uint8_t* out, size_t len) const;
+
+private:
+    uint32_t key_r[32];
+    SM4BlocksFn serial;
+};
+
+#endif // SM4_MODES_H
@@ -0,0 +1,184 @@
+#include "sm4_xts.h"
+#include "sm4_engine.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace {
+
+// 一次交给批量内核的分组数：正好是一个 4096 字节扇区
+constexpr size_t XTS_BATCH = 256;
+
+// 一次批量加密的扇区 tweak 数
+constexpr size_t TWEAK_BATCH = 16;
+
+// 单线程区间下限，与 CTR 相同
+constexpr size_t PARALLEL_MIN_BYTES = 256 * 1024;
+
+inline uint64_t loadLE64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline void storeLE64(uint64_t v, uint8_t* p) {
+    std::memcpy(p, &v, 8);
+}
+
+inline void xor16(const uint8_t* a, const uint8_t* b, uint8_t* out) {
+    uint64_t a0 = loadLE64(a) ^ loadLE64(b);
+    uint64_t a1 = loadLE64(a + 8) ^ loadLE64(b + 8);
+    storeLE64(a0, out);
+    storeLE64(a1, out + 8);
+}
+
+/* T·α：128 位小端整数左移一位，移出的最高位按 x^7 + x^2 + x + 1（0x87）折回 */
+inline void mulAlpha(uint64_t& lo, uint64_t& hi) {
+    uint64_t carry = hi >> 63;
+    hi = (hi << 1) | (lo >> 63);
+    lo = (lo << 1) ^ (0x87 & (0 - carry));
+}
+
+} // namespace
+
+SM4_XTS::SM4_XTS(const uint8_t key[KEY_SIZE], SM4BlocksFn blocks)
+    : blocks(blocks ? blocks : SM4Engine::blocks()) {
+    // 比较不因第一个不同的字节提前结束
+    uint8_t diff = 0;
+    for (int i = 0; i < 16; ++i) diff |= key[i] ^ key[16 + i];
+    keysDistinct = diff != 0;
+    SM4::initContext(key, ctx);
+    SM4::keyGenerate(key + 16, key_t);
+}
+
+SM4_XTS::SM4_XTS(const std::vector<unsigned char>& key, SM4BlocksFn blocks)
+    : SM4_XTS(key.data(), blocks) {}
+
+void SM4_XTS::cryptSector(bool decrypting, const uint8_t t0[16], const uint8_t* in, uint8_t* out,
+                          size_t len) const {
+    assert(len >= SM4::BLOCK_SIZE);
+    const uint32_t* rk = decrypting ? ctx.rk_dec : ctx.rk_enc;
+    uint64_t lo = loadLE64(t0), hi = loadLE64(t0 + 8);
+    size_t rest = len % SM4::BLOCK_SIZE;
+    // 需要密文窃取时，最后一个整分组与不完整分组单独处理
+    size_t bulk = len / SM4::BLOCK_SIZE - (rest ? 1 : 0);
+
+    alignas(64) uint8_t tw[XTS_BATCH * SM4::BLOCK_SIZE];
+    alignas(64) uint8_t buf[XTS_BATCH * SM4::BLOCK_SIZE];
+    while (bulk) {
+        size_t n = std::min(bulk, XTS_BATCH);
+        for (size_t i = 0; i < n; ++i) {
+            storeLE64(lo, tw + i * 16);
+            storeLE64(hi, tw + i * 16 + 8);
+            mulAlpha(lo, hi);
+            xor16(in + i * 16, tw + i * 16, buf + i * 16);
+        }
+        blocks(rk, buf, buf, n);
+        for (size_t i = 0; i < n; ++i) {
+            xor16(buf + i * 16, tw + i * 16, out + i * 16);
+        }
+        in += n * 16;
+        out += n * 16;
+        bulk -= n;
+    }
+    if (!rest) return;
+
+    /*
+     * 密文窃取：设最后一个整分组用 T_{m-1}，不完整分组用 T_m
+     * 加密先用 T_{m-1} 处理整分组，解密则先用 T_m，第二步用另一个 tweak
+     */
+    uint8_t ta[16], tb[16];
+    storeLE64(lo, ta);
+    storeLE64(hi, ta + 8);
+    mulAlpha(lo, hi);
+    storeLE64(lo, tb);
+    storeLE64(hi, tb + 8);
+    const uint8_t* t1 = decrypting ? tb : ta;
+    const uint8_t* t2 = decrypting ? ta : tb;
+
+    uint8_t x[16], y[16];
+    xor16(in, t1, x);
+    blocks(rk, x, x, 1);
+    xor16(x, t1, x);
+
+    // 不完整分组补上 x 的尾部，先读入再写出，支持原地操作
+    std::memcpy(y, in + 16, rest);
+    std::memcpy(y + rest, x + rest, 16 - rest);
+    xor16(y, t2, y);
+    blocks(rk, y, y, 1);
+    xor16(y, t2, out);
+    std::memcpy(out + 16, x, rest);
+}
+
+bool SM4_XTS::encryptSector(uint64_t sector, const uint8_t* in, uint8_t* out, size_t len) const {
+    if (len < SM4::BLOCK_SIZE || !keysDistinct) return false;
+    uint8_t t0[16] = {0};
+    storeLE64(sector, t0);
+    blocks(key_t, t0, t0, 1);
+    cryptSector(false, t0, in, out, len);
+    return true;
+}
+
+bool SM4_XTS::decryptSector(uint64_t sector, const uint8_t* in, uint8_t* out, size_t len) const {
+    if (len < SM4::BLOCK_SIZE || !keysDistinct) return false;
+    uint8_t t0[16] = {0};
+    storeLE64(sector, t0);
+    blocks(key_t, t0, t0, 1);
+    cryptSector(true, t0, in, out, len);
+    return true;
+}
+
+void SM4_XTS::cryptRange(bool decrypting, uint64_t firstSector, const uint8_t* in, uint8_t* out,
+                         size_t sectorSize, size_t count) const {
+    alignas(64) uint8_t t0[TWEAK_BATCH * SM4::BLOCK_SIZE];
+    while (count) {
+        size_t n = std::min(count, TWEAK_BATCH);
+        std::memset(t0, 0, n * SM4::BLOCK_SIZE);
+        for (size_t i = 0; i < n; ++i) {
+            storeLE64(firstSector + i, t0 + i * 16);
+        }
+        blocks(key_t, t0, t0, n);
+        for (size_t i = 0; i < n; ++i) {
+            cryptSector(decrypting, t0 + i * 16, in, out, sectorSize);
+            in += sectorSize;
+            out += sectorSize;
+        }
+        firstSector += n;
+        count -= n;
+    }
+}
+
+void SM4_XTS::cryptSectors(bool decrypting, uint64_t firstSector, const uint8_t* in, uint8_t* out,
+                           size_t sectorSize, size_t count, unsigned threads) const {
+    ThreadPool& pool = ThreadPool::global();
+    size_t maxTasks = threads ? threads : pool.size();
+    size_t tasks = std::min(maxTasks, sectorSize * count / PARALLEL_MIN_BYTES);
+    if (tasks <= 1) {
+        cryptRange(decrypting, firstSector, in, out, sectorSize, count);
+        return;
+    }
+
+    size_t chunk = (count + tasks - 1) / tasks;
+    pool.parallelFor(tasks, [&](size_t t) {
+        size_t begin = t * chunk;
+        if (begin >= count) return;
+        size_t n = std::min(chunk, count - begin);
+        cryptRange(decrypting, firstSector + begin, in + begin * sectorSize, out + begin * sectorSize,
+                   sectorSize, n);
+    });
+}
+
+bool SM4_XTS::encryptSectors(uint64_t firstSector, const uint8_t* in, uint8_t* out, size_t sectorSize,
+                             size_t count, unsigned threads) const {
+    if (sectorSize < SM4::BLOCK_SIZE || !keysDistinct) return false;
+    cryptSectors(false, firstSector, in, out, sectorSize, count, threads);
+    return true;
+}
+
+bool SM4_XTS::decryptSectors(uint64_t firstSector, const uint8_t* in, uint8_t* out, size_t sectorSize,
+                             size_t count, unsigned threads) const {
+    if (sectorSize < SM4::BLOCK_SIZE || !keysDistinct) return false;
+    cryptSectors(true, firstSector, in, out, sectorSize, count, threads);
+    return true;
+}
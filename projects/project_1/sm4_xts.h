@@ -0,0 +1,69 @@
+#ifndef SM4_XTS_H
+#define SM4_XTS_H
+
+#include "sm4.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * SM4_XTS
+ * 面向扇区的存储加密（IEEE 1619-2018 XTS，分组密码替换为 SM4）。
+ *
+ * 密钥 32 字节：K1 加密数据，K2 加密 tweak。扇区号按 128 位小端整数作为 tweak 输入，
+ * T_0 = E(K2, 扇区号)，T_j = T_0·α^j（GF(2^128)，模 x^128 + x^7 + x^2 + x + 1，小端位序），
+ *     C_j = E(K1, P_j ^ T_j) ^ T_j
+ * 扇区长度不是 16 的倍数时对最后两个分组做密文窃取。
+ *
+ * 一个扇区的全部 tweak 先连续生成到缓冲区，再把整个扇区（512 字节 32 个分组、
+ * 4096 字节 256 个分组）一次交给批量分组内核；不同扇区互相独立，可在线程池上并行。
+ */
+class SM4_XTS {
+public:
+    static constexpr size_t KEY_SIZE = 32;
+
+    /*
+     * @param key: 32 字节密钥 K1 || K2
+     * @param blocks: 批量分组内核，默认 SM4Engine::blocks()（按 CPU 自动选择）
+     * IEEE 1619-2018 5.1 要求 K1 与 K2 不同：两者相同时 tweak 的加密结果可由数据密钥得到，
+     * 对象构造后 valid() 为 false，所有加解密调用返回 false 且不写 out
+     */
+    explicit SM4_XTS(const uint8_t key[KEY_SIZE], SM4BlocksFn blocks = nullptr);
+    explicit SM4_XTS(const std::vector<unsigned char>& key, SM4BlocksFn blocks = nullptr);
+
+    // K1 与 K2 不同
+    bool valid() const { return keysDistinct; }
+
+    /*
+     * 加解密一个扇区（数据单元）：in 与 out 可以相同
+     * len < 16 时无法做密文窃取，返回 false 且不写 out；valid() 为 false 时同样如此
+     */
+    bool encryptSector(uint64_t sector, const uint8_t* in, uint8_t* out, size_t len) const;
+    bool decryptSector(uint64_t sector, const uint8_t* in, uint8_t* out, size_t len) const;
+
+    /*
+     * 连续 count 个扇区，扇区号从 firstSector 起递增
+     * 按扇区区间分发到全局线程池；threads 为 0 时使用全部线程，数据量较小时退化为单线程
+     * sectorSize < 16 或 valid() 为 false 时返回 false 且不写 out
+     */
+    bool encryptSectors(uint64_t firstSector, const uint8_t* in, uint8_t* out, size_t sectorSize,
+                        size_t count, unsigned threads = 0) const;
+    bool decryptSectors(uint64_t firstSector, const uint8_t* in, uint8_t* out, size_t sectorSize,
+                        size_t count, unsigned threads = 0) const;
+
+private:
+    SM4Context ctx;         // K1 的加密与逆序的解密轮密钥
+    uint32_t key_t[32];     // K2 轮密钥，只用于加密 tweak
+    SM4BlocksFn blocks;
+    bool keysDistinct;
+
+    // t0 为已加密的 T_0，len >= 16 由调用方保证
+    void cryptSector(bool decrypting, const uint8_t t0[16], const uint8_t* in, uint8_t* out, size_t len) const;
+    // 单线程处理一段连续扇区：每 16 个扇区的 T_0 合并为一次批量加密
+    void cryptRange(bool decrypting, uint64_t firstSector, const uint8_t* in, uint8_t* out,
+                    size_t sectorSize, size_t count) const;
+    void cryptSectors(bool decrypting, uint64_t firstSector, const uint8_t* in, uint8_t* out,
+                      size_t sectorSize, size_t count, unsigned threads) const;
+};
+
+#endif // SM4_XTS_H
@@ -0,0 +1,641 @@
+#include "sm4.h"
+#include "SM4_T_Table.h"
+#include "SM4_SIMD.h"
+#include "SM4_Bitslice.h"
+#include "sm4_ctr.h"
+#include "sm4_gcm.h"
+#include "sm4_modes.h"
+#include "sm4_xts.h"
+#include "sm4_key_cache.h"
+#include "sm4_engine.h"
+#include "sm4_file.h"
+#include <iostream>
+#include <iomanip>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <unistd.h>
+
+static void printHex(const char* label, const uint8_t* data, size_t len) {
+    std::cout << label;
+    for (size_t i = 0; i < len; ++i) {
+        std::cout << std::hex << std::setw(2) << std::setfill('0') << int(data[i]);
+    }
+    std::cout << std::dec << "\n";
+}
+
+// GM/T 0002-2012 附录 A 示例 1 的密钥、明文与密文
+static const uint8_t KEY[16] = {
+    0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF,
+    0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10
+};
+static const uint8_t EXPECTED1[16] = {
+    0x68, 0x1E, 0xDF, 0x34, 0xD2, 0x06, 0x96, 0x5E,
+    0x86, 0xB3, 0xE9, 0x4F, 0x53, 0x6E, 0x42, 0x46
+};
+
+/*
+ * 校验一个实现：标准向量 + 任意分组数下与参考实现 SM4 的批量结果一致
+ */
+template <typename Cipher>
+static void checkEngine(const std::string& name) {
+    Cipher cipher(KEY);
+    SM4 reference(KEY);
+
+    uint8_t block[16];
+    cipher.encrypt_blocks(KEY, block, 1);
+    assert(std::memcmp(block, EXPECTED1, 16) == 0);
+
+    for (size_t n : {1, 2, 7, 8, 9, 16, 17, 63, 64, 65, 200, 255, 256, 300, 456}) {
+        std::vector<uint8_t> buf(n * 16), enc(n * 16), ref(n * 16), dec(n * 16);
+        for (size_t i = 0; i < buf.size(); ++i) buf[i] = uint8_t(i * 131 + n);
+        cipher.encrypt_blocks(buf.data(), enc.data(), n);
+        reference.encrypt_blocks(buf.data(), ref.data(), n);
+        assert(enc == ref);
+        cipher.decrypt_blocks(enc.data(), dec.data(), n);
+        assert(dec == buf);
+    }
+    std::cout << name << " OK\n";
+}
+
+/*
+ * 校验一个 cryptBlocks(rk, in, out, n) 形式的批量内核
+ */
+static void checkKernel(const std::string& name,
+                        void (*kernel)(const uint32_t*, const uint8_t*, uint8_t*, size_t)) {
+    uint32_t rk[32];
+    SM4::keyGenerate(KEY, rk);
+    SM4 reference(KEY);
+    for (size_t n : {1, 3, 8, 15, 16, 17, 33, 100}) {
+        std::vector<uint8_t> buf(n * 16), enc(n * 16), ref(n * 16);
+        for (size_t i = 0; i < buf.size(); ++i) buf[i] = uint8_t(i * 29 + n);
+        kernel(rk, buf.data(), enc.data(), n);
+        reference.encrypt_blocks(buf.data(), ref.data(), n);
+        assert(enc == ref);
+    }
+    std::cout << name << " OK\n";
+}
+
+static std::vector<uint8_t> fromHex(const std::string& hex) {
+    std::vector<uint8_t> out(hex.size() / 2);
+    for (size_t i = 0; i < out.size(); ++i) out[i] = uint8_t(std::stoi(hex.substr(2 * i, 2), nullptr, 16));
+    return out;
+}
+
+/*
+ * CTR 模式：与 OpenSSL sm4-ctr 的结果一致（含计数器低 64 位进位），任意偏移/多线程/流式结果一致
+ */
+static void checkCTR() {
+    const std::string expected[2] = {
+        "05928d792280459911cfbed2b6f69c061c7d8cc3cf3561a57123aa2546ce78c6ff30a3183529fa7a19cf50fec422c121"
+        "97f237123f7c6dddbb00119e01974b137a1610f6bf31215334944c413b39c91f28bc58aea65d65612c04b7633ed8dc279ed986c0",
+        "2f5b92016929bbb80ce4fc04fd6e13f012a261742eb932e54c74a7d257e977030adc40cde4eea958a1e668324d0b2752"
+        "e2844370ea048e629a7c64a96948ee86ebcd2e6bd67acc76914b18689c3745e05dd5ca0aed2723a946b7ea1ce31307699b3593d1",
+    };
+    const std::string ivs[2] = { "000102030405060708090A0B0C0D0E0F", "00000000000000FFFFFFFFFFFFFFFFFE" };
+    std::vector<uint8_t> msg(100);
+    for (size_t i = 0; i < msg.size(); ++i) msg[i] = uint8_t(i * 7 + 3);
+
+    for (int v = 0; v < 2; ++v) {
+        SM4_CTR ctr(KEY, fromHex(ivs[v]).data());
+        std::vector<uint8_t> out(msg.size());
+        ctr.crypt(msg.data(), out.data(), msg.size());
+        assert(out == fromHex(expected[v]));
+
+        // 从任意偏移开始，与整体结果的对应片段一致
+        for (size_t off : {1, 15, 16, 17, 33, 99}) {
+            std::vector<uint8_t> part(msg.size() - off);
+            ctr.crypt(msg.data() + off, part.data(), part.size(), off);
+            assert(std::equal(part.begin(), part.end(), out.begin() + off));
+        }
+    }
+
+    // 多线程、流式与单线程结果一致；解密恢复明文
+    const size_t len = 3 * 1024 * 1024 + 13;
+    std::vector<uint8_t> big(len), serial(len), parallel(len), stream(len);
+    for (size_t i = 0; i < len; ++i) big[i] = uint8_t(i ^ (i >> 9));
+    SM4_CTR ctr(KEY, KEY);
+    ctr.crypt(big.data(), serial.data(), len, 5);
+    ctr.cryptParallel(big.data(), parallel.data(), len, 5, 4);
+    assert(parallel == serial);
+    ctr.seek(5);
+    for (size_t pos = 0, step = 1; pos < len; pos += step, step = step * 3 + 1) {
+        size_t n = std::min(step, len - pos);
+        ctr.update(big.data() + pos, stream.data() + pos, n);
+    }
+    assert(stream == serial);
+    ctr.cryptParallel(parallel.data(), parallel.data(), len, 5);
+    assert(parallel == big);
+    std::cout << "Test 7 - SM4_CTR OK\n";
+}
+
+/*
+ * SM4-GCM：RFC 8998 附录 A.1 向量（两种 GHASH 后端），
+ * 多种长度下 PCLMULQDQ 与查表后端结果一致，篡改后拒绝解密
+ */
+static void checkGCM() {
+    const std::vector<uint8_t> iv = fromHex("00001234567800000000ABCD");
+    const std::vector<uint8_t> aad = fromHex("FEEDFACEDEADBEEFFEEDFACEDEADBEEFABADDAD2");
+    const std::vector<uint8_t> pt = fromHex(
+        "AAAAAAAAAAAAAAAABBBBBBBBBBBBBBBBCCCCCCCCCCCCCCCCDDDDDDDDDDDDDDDD"
+        "EEEEEEEEEEEEEEEEFFFFFFFFFFFFFFFFEEEEEEEEEEEEEEEEAAAAAAAAAAAAAAAA");
+    const std::vector<uint8_t> ct = fromHex(
+        "17F399F08C67D5EE19D0DC9969C4BB7D5FD46FD3756489069157B282BB200735"
+        "D82710CA5C22F0CCFA7CBF93D496AC15A56834CBCF98C397B4024A2691233B8D");
+    const std::vector<uint8_t> tag = fromHex("83DE3541E4C2B58177E065A9BF7B62EC");
+
+    SM4_GCM gcm(KEY);
+    SM4_GCM table(KEY);
+    table.useClmul(false);
+    for (const SM4_GCM* g : {&gcm, &table}) {
+        std::vector<uint8_t> out(pt.size()), back(pt.size());
+        uint8_t t[16];
+        g->encrypt(iv.data(), iv.size(), aad.data(), aad.size(), pt.data(), out.data(), pt.size(), t);
+        assert(out == ct);
+        assert(std::memcmp(t, tag.data(), 16) == 0);
+        assert(g->decrypt(iv.data(), iv.size(), aad.data(), aad.size(), out.data(), back.data(), out.size(), t));
+        assert(back == pt);
+    }
+
+    // 跨越 8 分组聚合与 64 分组分段边界的长度，以及非 96 位 IV
+    for (size_t len : {0, 1, 16, 127, 128, 129, 1023, 1024, 1025, 5000}) {
+        std::vector<uint8_t> msg(len), a(len % 37), v(len % 2 ? 12 : 1 + len % 29);
+        for (size_t i = 0; i < len; ++i) msg[i] = uint8_t(i * 13 + 1);
+        for (size_t i = 0; i < a.size(); ++i) a[i] = uint8_t(i + 5);
+        for (size_t i = 0; i < v.size(); ++i) v[i] = uint8_t(i * 3);
+        std::vector<uint8_t> c1(len), c2(len);
+        uint8_t t1[16], t2[16];
+        gcm.encrypt(v.data(), v.size(), a.data(), a.size(), msg.data(), c1.data(), len, t1);
+        table.encrypt(v.data(), v.size(), a.data(), a.size(), msg.data(), c2.data(), len, t2);
+        assert(c1 == c2);
+        assert(std::memcmp(t1, t2, 16) == 0);
+
+        // 原地解密
+        assert(gcm.decrypt(v.data(), v.size(), a.data(), a.size(), c1.data(), c1.data(), len, t1));
+        assert(c1 == msg);
+        t2[15] ^= 1;
+        assert(!table.decrypt(v.data(), v.size(), a.data(), a.size(), c2.data(), c2.data(), len, t2));
+    }
+
+    // 只有 AAD 的消息：无密文时 in/out 可以为空指针
+    uint8_t t[16];
+    gcm.encrypt(iv.data(), iv.size(), aad.data(), aad.size(), nullptr, nullptr, 0, t);
+    assert(gcm.decrypt(iv.data(), iv.size(), aad.data(), aad.size(), nullptr, nullptr, 0, t));
+    t[0] ^= 1;
+    assert(!gcm.decrypt(iv.data(), iv.size(), aad.data(), aad.size(), nullptr, nullptr, 0, t));
+    std::cout << "Test 8 - SM4_GCM (" << (gcm.usingClmul() ? "pclmul" : "table") << " GHASH) OK\n";
+}
+
+// 记录调用次数的分组内核，用来确认模式没有绕过指定的内核
+static size_t countedBlocks = 0;
+
+static void countingBlocks(const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t nblocks) {
+    countedBlocks += nblocks;
+    SM4::cryptBlocks(rk, in, out, nblocks);
+}
+
+/*
+ * CBC/CFB/OFB：与 OpenSSL sm4-cbc/sm4-cfb/sm4-ofb 的结果一致（CBC 使用 PKCS#7 填充），
+ * 分段调用与一次调用一致，原地解密恢复明文，串行的加密链同样使用指定的内核
+ */
+static void checkModes() {
+    const std::vector<uint8_t> iv = fromHex("000102030405060708090A0B0C0D0E0F");
+    const std::vector<uint8_t> cbc = fromHex(
+        "fdbb91d70627507224eb794707f82aa5b3dd73633d2c1a6ba1bb39ac629209ddbe584c65a29943939841e48c48dc948c"
+        "56b29e4b38889aa1233829826b6bb2cae70d360e1e6114a6358ece2e13692e20c37286061806d954f18b1f93926c1e5c"
+        "5edc6e29bbd7b0107ffb763ec7ef2ab3");
+    const std::vector<uint8_t> cfb = fromHex(
+        "05928d792280459911cfbed2b6f69c06ff6a67ad677d67b064d16ac762455ff40743679a7b1dd36895b22437044a06a4"
+        "9e20b8e05a4491a54418e87cfdfeb49f3034c98ac1e20e9d98f61453d19e017a61ac8f6a03c6a48fb625130fda6cb2f3"
+        "0a87eb20");
+    const std::vector<uint8_t> ofb = fromHex(
+        "05928d792280459911cfbed2b6f69c068095c3c43815c7d9caed55541aed3dfcb8ad69b0700f0a3c2bcc2d16138e1bae"
+        "644829ad179f16bf7066932a65904e93544eea6f6394aacee9d25cea956256ec3be008fa71a57ddf99f9d80fef42565d"
+        "6de2fb6f");
+    std::vector<uint8_t> msg(100);
+    for (size_t i = 0; i < msg.size(); ++i) msg[i] = uint8_t(i * 7 + 3);
+
+    SM4_CBC cbcCipher(KEY);
+    std::vector<uint8_t> out = cbcCipher.encryptPadded(iv.data(), msg);
+    assert(out == cbc);
+    std::vector<uint8_t> back;
+    assert(cbcCipher.decryptPadded(iv.data(), out, back) && back == msg);
+    out.back() ^= 1; // 破坏最后一个分组，填充校验应失败
+    assert(!cbcCipher.decryptPadded(iv.data(), out, back));
+
+    uint8_t chain[16];
+    SM4_CFB cfbCipher(KEY);
+    std::memcpy(chain, iv.data(), 16);
+    out.assign(msg.size(), 0);
+    cfbCipher.encrypt(chain, msg.data(), out.data(), msg.size());
+    assert(out == cfb);
+    std::memcpy(chain, iv.data(), 16);
+    cfbCipher.decrypt(chain, out.data(), out.data(), out.size());
+    assert(out == msg);
+
+    SM4_OFB ofbCipher(KEY);
+    std::memcpy(chain, iv.data(), 16);
+    ofbCipher.crypt(chain, msg.data(), out.data(), msg.size());
+    assert(out == ofb);
+
+    // 跨越批量边界的长消息：分段与一次处理结果一致，原地解密
+    const size_t n = 16 * 5 + 3;
+    std::vector<uint8_t> big(n * 16), whole(n * 16), split(n * 16);
+    for (size_t i = 0; i < big.size(); ++i) big[i] = uint8_t(i * 29 + 1);
+    std::memcpy(chain, iv.data(), 16);
+    cbcCipher.encrypt(chain, big.data(), whole.data(), n);
+    std::memcpy(chain, iv.data(), 16);
+    cbcCipher.encrypt(chain, big.data(), split.data(), 17);
+    cbcCipher.encrypt(chain, big.data() + 17 * 16, split.data() + 17 * 16, n - 17);
+    assert(split == whole);
+    std::memcpy(chain, iv.data(), 16);
+    cbcCipher.decrypt(chain, whole.data(), whole.data(), 33);
+    cbcCipher.decrypt(chain, whole.data() + 33 * 16, whole.data() + 33 * 16, n - 33);
+    assert(whole == big);
+
+    std::memcpy(chain, iv.data(), 16);
+    cfbCipher.encrypt(chain, big.data(), whole.data(), big.size());
+    std::memcpy(chain, iv.data(), 16);
+    cfbCipher.decrypt(chain, whole.data(), whole.data(), 20 * 16);
+    cfbCipher.decrypt(chain, whole.data() + 20 * 16, whole.data() + 20 * 16, big.size() - 20 * 16);
+    assert(whole == big);
+
+    std::memcpy(chain, iv.data(), 16);
+    SM4_CBC(KEY, countingBlocks).encrypt(chain, big.data(), split.data(), n);
+    assert(countedBlocks == n);
+    std::memcpy(chain, iv.data(), 16);
+    cbcCipher.encrypt(chain, big.data(), whole.data(), n);
+    assert(split == whole);
+    std::memcpy(chain, iv.data(), 16);
+    SM4_CFB(KEY, countingBlocks).encrypt(chain, msg.data(), out.data(), msg.size());
+    assert(out == cfb && countedBlocks == n + 7);
+    std::memcpy(chain, iv.data(), 16);
+    SM4_OFB(KEY, countingBlocks).crypt(chain, msg.data(), out.data(), msg.size());
+    assert(out == ofb && countedBlocks == n + 14);
+    std::cout << "Test 9 - SM4_CBC/SM4_CFB/SM4_OFB OK\n";
+}
+
+// 一条串行链的吞吐（GB/s）：每次把上一次的输出作为唯一的分组交给内核，取 3 次中最快的一次
+static double serialRate(SM4BlocksFn kernel) {
+    uint32_t rk[32];
+    SM4::keyGenerate(KEY, rk);
+    const size_t n = 2048;
+    uint8_t x[16] = {0};
+    double best = 0;
+    for (int r = 0; r < 3; ++r) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i) kernel(rk, x, x, 1);
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        best = std::max(best, n * 16 / sec / 1e9);
+    }
+    return best;
+}
+
+/*
+ * 串行链的吞吐：每个后端的单分组内核不慢于把单个分组补齐后交给批量内核（原先的做法）；
+ * 与原先的 T 表路径相比，AES-NI/GFNI 的单分组内核每轮都要等 S 盒与 L 的向量延迟，恒定时间的代价
+ * 约为 2 倍，这里要求不低于 T 表的 1/3；位切片没有硬件 S 盒，只要求快于补齐
+ */
+static void checkSerialThroughput() {
+    const double ttable = serialRate(OptimizedSM4::cryptBlocks);
+    for (const auto& b : SM4Engine::backends()) {
+        if (!b.supported() || b.blocks == SM4::cryptBlocks) continue;
+        double serial = serialRate(b.serial), padded = serialRate(b.blocks);
+        std::cout << "         serial chain " << b.name << ": " << std::setprecision(3) << serial
+                  << " GB/s (padded " << padded << ", ttable " << ttable << ")\n" << std::setprecision(6);
+        assert(serial >= padded * 0.75);
+        if (b.blocks != SM4_Bitsliced::cryptBlocks) assert(serial >= ttable / 3);
+    }
+}
+
+/*
+ * SM4_XTS：按 IEEE 1619 定义逐分组用参考实现计算（含密文窃取），
+ * 与批量/多扇区/多线程结果一致，原地解密恢复明文
+ */
+static void xtsReference(const uint8_t key[32], uint64_t sector, const uint8_t* in, uint8_t* out, size_t len) {
+    SM4 k1(key), k2(key + 16);
+    uint8_t t[16] = {0};
+    for (int i = 0; i < 8; ++i) t[i] = uint8_t(sector >> (8 * i));
+    k2.encrypt_blocks(t, t, 1);
+    auto next = [&] {
+        uint8_t carry = t[15] >> 7;
+        for (int i = 15; i > 0; --i) t[i] = uint8_t((t[i] << 1) | (t[i - 1] >> 7));
+        t[0] = uint8_t((t[0] << 1) ^ (carry ? 0x87 : 0));
+    };
+    auto block = [&](const uint8_t* tw, const uint8_t* src, uint8_t* dst) {
+        uint8_t x[16];
+        for (int i = 0; i < 16; ++i) x[i] = src[i] ^ tw[i];
+        k1.encrypt_blocks(x, x, 1);
+        for (int i = 0; i < 16; ++i) dst[i] = x[i] ^ tw[i];
+    };
+    size_t m = len / 16, rest = len % 16;
+    for (size_t j = 0; j + (rest ? 1 : 0) < m; ++j, next()) block(t, in + j * 16, out + j * 16);
+    if (rest) {
+        uint8_t cc[16], pp[16];
+        size_t last = (m - 1) * 16;
+        block(t, in + last, cc);
+        next();
+        std::memcpy(pp, in + last + 16, rest);
+        std::memcpy(pp + rest, cc + rest, 16 - rest);
+        block(t, pp, out + last);
+        std::memcpy(out + last + 16, cc, rest);
+    }
+}
+
+static void checkXTS() {
+    uint8_t key[32];
+    for (int i = 0; i < 32; ++i) key[i] = uint8_t(i * 11 + 5);
+    SM4_XTS xts(key);
+    assert(xts.valid());
+
+    for (size_t len : {16, 17, 31, 32, 100, 512, 527, 4096, 4111}) {
+        std::vector<uint8_t> msg(len), ref(len), out(len);
+        for (size_t i = 0; i < len; ++i) msg[i] = uint8_t(i * 7 + len);
+        const uint64_t sector = 0x0123456789ABCDEFULL + len;
+        xtsReference(key, sector, msg.data(), ref.data(), len);
+        assert(xts.encryptSector(sector, msg.data(), out.data(), len));
+        assert(out == ref);
+        assert(xts.decryptSector(sector, out.data(), out.data(), len));
+        assert(out == msg);
+    }
+
+    // 不足一个分组无法做密文窃取，拒绝且不写输出
+    for (size_t len : {0, 1, 15}) {
+        std::vector<uint8_t> msg(16, 0x5A), out(16, 0xA5);
+        assert(!xts.encryptSector(7, msg.data(), out.data(), len));
+        assert(!xts.decryptSector(7, msg.data(), out.data(), len));
+        assert(!xts.encryptSectors(7, msg.data(), out.data(), len, 1));
+        assert(!xts.decryptSectors(7, msg.data(), out.data(), len, 1));
+        assert(out == std::vector<uint8_t>(16, 0xA5));
+    }
+
+    // K1 == K2 的密钥被拒绝；只差最后一个字节时正常工作
+    uint8_t same[32];
+    std::memcpy(same, key, 16);
+    std::memcpy(same + 16, key, 16);
+    SM4_XTS weak(same);
+    assert(!weak.valid());
+    {
+        std::vector<uint8_t> msg(512, 0x5A), out(512, 0xA5);
+        assert(!weak.encryptSector(7, msg.data(), out.data(), 512));
+        assert(!weak.decryptSector(7, msg.data(), out.data(), 512));
+        assert(!weak.encryptSectors(7, msg.data(), out.data(), 16, 32));
+        assert(!weak.decryptSectors(7, msg.data(), out.data(), 16, 32));
+        assert(out == std::vector<uint8_t>(512, 0xA5));
+        same[31] ^= 1;
+        assert(SM4_XTS(same).valid());
+    }
+
+    // 多扇区、多线程与逐扇区结果一致
+    for (size_t sectorSize : {512, 4096}) {
+        const size_t count = 1024 * 1024 / sectorSize + 3;
+        std::vector<uint8_t> image(sectorSize * count), enc(image.size()), one(sectorSize);
+        for (size_t i = 0; i < image.size(); ++i) image[i] = uint8_t(i ^ (i >> 11));
+        xts.encryptSectors(100, image.data(), enc.data(), sectorSize, count, 4);
+        for (size_t s : {size_t(0), size_t(1), size_t(17), count - 1}) {
+            xts.encryptSector(100 + s, image.data() + s * sectorSize, one.data(), sectorSize);
+            assert(std::equal(one.begin(), one.end(), enc.begin() + s * sectorSize));
+        }
+        xts.decryptSectors(100, enc.data(), enc.data(), sectorSize, count);
+        assert(enc == image);
+    }
+    std::cout << "Test 10 - SM4_XTS OK\n";
+}
+
+/*
+ * 密钥上下文：批量 SIMD 密钥拓展与逐个拓展一致，由上下文构造的各实现与由密钥构造的一致，
+ * LRU 缓存的命中、淘汰与容量
+ */
+static void checkKeySchedule() {
+    const size_t n = 41;
+    std::vector<uint8_t> keys(n * 16);
+    for (size_t i = 0; i < keys.size(); ++i) keys[i] = uint8_t(i * 37 + 11);
+    std::vector<SM4Context> batch(n);
+    SM4_SIMD::keyGenerateBatch(keys.data(), batch.data(), n);
+    for (size_t i = 0; i < n; ++i) {
+        SM4Context one;
+        SM4::initContext(keys.data() + i * 16, one);
+        assert(std::memcmp(&one, &batch[i], sizeof(one)) == 0);
+    }
+
+    SM4Context ctx;
+    SM4::initContext(KEY, ctx);
+    SM4 fromCtx(ctx);
+    OptimizedSM4 ttable(ctx);
+    uint8_t block[16], back[16];
+    fromCtx.encrypt_blocks(KEY, block, 1);
+    assert(std::memcmp(block, EXPECTED1, 16) == 0);
+    ttable.decrypt_blocks(block, back, 1);
+    assert(std::memcmp(back, KEY, 16) == 0);
+
+    SM4KeyCache cache(4);
+    for (size_t i = 0; i < 5; ++i) {
+        assert(!cache.get(keys.data() + i * 16, ctx));
+        assert(std::memcmp(&ctx, &batch[i], sizeof(ctx)) == 0);
+    }
+    assert(cache.size() == 4);
+    assert(cache.get(keys.data() + 4 * 16, ctx));  // 最近插入，命中
+    assert(!cache.get(keys.data(), ctx));          // 最久未用，已被淘汰
+    assert(std::memcmp(&ctx, &batch[0], sizeof(ctx)) == 0);
+    assert(cache.hits() == 1 && cache.misses() == 6);
+    cache.clear();
+    assert(cache.size() == 0);
+    std::cout << "Test 11 - SM4Context / keyGenerateBatch / SM4KeyCache OK\n";
+}
+
+/*
+ * SM4Engine：本机支持的每个后端的分组内核、单分组内核与以它为内核的 CTR 都与参考实现一致，
+ * 运行时切换后端生效，无效名称被拒绝
+ */
+static void checkDispatch() {
+    uint32_t rk[32];
+    SM4::keyGenerate(KEY, rk);
+    std::vector<uint8_t> msg(77 * 16), ref(msg.size()), out(msg.size());
+    for (size_t i = 0; i < msg.size(); ++i) msg[i] = uint8_t(i * 13 + 5);
+    SM4_CTR::xorKeystream(SM4::cryptBlocks, rk, KEY, msg.data(), ref.data(), 77);
+
+    for (const auto& b : SM4Engine::backends()) {
+        if (!b.supported()) continue;
+        checkKernel(std::string("         SM4Engine ") + b.name, b.blocks);
+        checkKernel(std::string("         SM4Engine ") + b.name + " serial", b.serial);
+        SM4_CTR::xorKeystream(b.blocks, rk, KEY, msg.data(), out.data(), 77);
+        assert(out == ref);
+    }
+
+    assert(!SM4Engine::selectBackend("no-such-backend"));
+    assert(SM4Engine::selectBackend("ttable"));
+    assert(std::string(SM4Engine::backendName()) == "ttable");
+    SM4Engine engine(KEY);
+    uint8_t block[16], back[16];
+    engine.encrypt_blocks(KEY, block, 1);
+    assert(std::memcmp(block, EXPECTED1, 16) == 0);
+    engine.decrypt_blocks(block, back, 1);
+    assert(std::memcmp(back, KEY, 16) == 0);
+
+    assert(SM4Engine::selectGhash("table") && !SM4Engine::ghashClmul());
+    assert(!SM4Engine::selectGhash("no-such-ghash"));
+    assert(SM4Engine::selectBackend("auto") && SM4Engine::selectGhash("auto"));
+    std::cout << "Test 12 - SM4Engine (" << SM4Engine::backendName() << ") OK\n";
+}
+
+static std::vector<uint8_t> readAll(int fd) {
+    std::vector<uint8_t> data(size_t(lseek(fd, 0, SEEK_END)));
+    if (!data.empty()) assert(pread(fd, data.data(), data.size(), 0) == ssize_t(data.size()));
+    return data;
+}
+
+static void writeAll(int fd, const std::vector<uint8_t>& data) {
+    assert(ftruncate(fd, 0) == 0);
+    if (!data.empty()) assert(pwrite(fd, data.data(), data.size(), 0) == ssize_t(data.size()));
+}
+
+/*
+ * SM4FileCipher：CTR/GCM、mmap/pread、单/多线程往返一致，
+ * 块内容与 SM4_CTR / SM4_GCM 直接计算的结果相同，篡改或截断后拒绝解密
+ */
+static void checkFileCipher() {
+    const size_t chunk = 4096;
+    std::vector<uint8_t> plain(5 * chunk + 100);
+    for (size_t i = 0; i < plain.size(); ++i) plain[i] = uint8_t(i * 7 + (i >> 8));
+    FILE* fin = std::tmpfile();
+    FILE* fenc = std::tmpfile();
+    FILE* fdec = std::tmpfile();
+    assert(fin && fenc && fdec);
+    int in = fileno(fin), enc = fileno(fenc), dec = fileno(fdec);
+    const size_t H = SM4FileCipher::HEADER_SIZE;
+
+    for (SM4FileCipher::Mode mode : {SM4FileCipher::CTR, SM4FileCipher::GCM}) {
+        for (unsigned threads : {1u, 3u}) {
+            for (bool mmapInput : {true, false}) {
+                SM4FileCipher cipher(KEY, mode, chunk, threads);
+                cipher.useMmap(mmapInput);
+                writeAll(in, plain);
+                assert(cipher.encrypt(in, enc));
+                std::vector<uint8_t> ct = readAll(enc);
+                assert(cipher.decrypt(enc, dec));
+                assert(readAll(dec) == plain);
+
+                const uint8_t* iv = ct.data() + 12;
+                if (mode == SM4FileCipher::CTR) {
+                    assert(ct.size() == H + plain.size());
+                    std::vector<uint8_t> ref(plain.size());
+                    SM4_CTR(KEY, iv).crypt(plain.data(), ref.data(), plain.size());
+                    assert(std::equal(ref.begin(), ref.end(), ct.begin() + H));
+                    continue;
+                }
+
+                assert(ct.size() == H + plain.size() + 6 * SM4_GCM::TAG_SIZE);
+                uint8_t nonce[12] = {0}, aad[H + 9] = {0}, tag[16];
+                std::memcpy(nonce, iv, 8);
+                std::memcpy(aad, ct.data(), H);
+                std::vector<uint8_t> first(chunk);
+                SM4_GCM(KEY).encrypt(nonce, 12, aad, sizeof(aad), plain.data(), first.data(), chunk, tag);
+                assert(std::equal(first.begin(), first.end(), ct.begin() + H));
+                assert(std::memcmp(tag, ct.data() + H + chunk, 16) == 0);
+
+                // 篡改一个字节、删除末块都会认证失败，输出被清空
+                std::vector<uint8_t> bad = ct;
+                bad[H + 2 * (chunk + 16) + 5] ^= 1;
+                writeAll(enc, bad);
+                std::string error;
+                assert(!cipher.decrypt(enc, dec, &error) && !error.empty());
+                assert(readAll(dec).empty());
+                bad = ct;
+                bad.resize(H + 5 * (chunk + 16));
+                writeAll(enc, bad);
+                assert(!cipher.decrypt(enc, dec));
+            }
+        }
+    }
+
+    // 块长超过上限：加密时拒绝，文件头中的块长被篡改时在分配缓冲区之前拒绝
+    std::string error;
+    writeAll(in, plain);
+    assert(!SM4FileCipher(KEY, SM4FileCipher::GCM, SM4FileCipher::MAX_CHUNK + 16).encrypt(in, enc, &error));
+    SM4FileCipher cipher(KEY);
+    assert(cipher.encrypt(in, enc));
+    std::vector<uint8_t> huge = readAll(enc);
+    huge[8] = huge[9] = huge[10] = 0xFF;
+    huge[11] = 0xF0;
+    writeAll(enc, huge);
+    assert(!cipher.decrypt(enc, dec, &error) && error == "invalid chunk size in header");
+
+    // 空文件：GCM 仍输出一个带标签的末块
+    SM4FileCipher gcm(KEY);
+    writeAll(in, {});
+    assert(gcm.encrypt(in, enc));
+    assert(readAll(enc).size() == H + SM4_GCM::TAG_SIZE);
+    assert(gcm.decrypt(enc, dec) && readAll(dec).empty());
+
+    std::fclose(fin);
+    std::fclose(fenc);
+    std::fclose(fdec);
+    std::cout << "Test 13 - SM4FileCipher OK\n";
+}
+
+/*
+ * SM4 算法单元测试（GM/T 0002-2012 附录 A 标准示例）
+ */
+int main() {
+    const uint8_t expected2[16] = {
+        0x59, 0x52, 0x98, 0xC7, 0xC6, 0xFD, 0x27, 0x1F,
+        0x04, 0x02, 0xF8, 0x04, 0xC3, 0x3D, 0x3F, 0x66
+    };
+
+    // 测试 1: vector 接口单分组加解密
+    std::vector<unsigned char> keyVec(KEY, KEY + 16);
+    std::vector<unsigned char> plaintext(KEY, KEY + 16);
+    SM4 sm4_cipher(keyVec);
+    std::vector<unsigned char> ciphertext = sm4_cipher.encrypt(plaintext);
+    std::vector<unsigned char> decrypted = sm4_cipher.decrypt(ciphertext);
+
+    printHex("Test 1 - Ciphertext: ", ciphertext.data(), 16);
+    printHex("         Decrypted:  ", decrypted.data(), 16);
+    assert(std::memcmp(ciphertext.data(), EXPECTED1, 16) == 0);
+    assert(decrypted == plaintext);
+
+    // 测试 2: 批量接口原地迭代加密 1000000 次
+    uint8_t block[16];
+    std::memcpy(block, KEY, 16);
+    for (int i = 0; i < 1000000; ++i) {
+        sm4_cipher.encrypt_blocks(block, block, 1);
+    }
+    printHex("Test 2 - 1000000 rounds: ", block, 16);
+    assert(std::memcmp(block, expected2, 16) == 0);
+
+    // 测试 3: 多分组批量加解密与单分组结果一致
+    const size_t n = 37;
+    std::vector<uint8_t> buf(n * 16), enc(n * 16), dec(n * 16);
+    for (size_t i = 0; i < buf.size(); ++i) buf[i] = uint8_t(i * 131 + 7);
+    sm4_cipher.encrypt_blocks(buf.data(), enc.data(), n);
+    for (size_t i = 0; i < n; ++i) {
+        std::vector<unsigned char> one(buf.begin() + i * 16, buf.begin() + i * 16 + 16);
+        assert(std::memcmp(sm4_cipher.encrypt(one).data(), enc.data() + i * 16, 16) == 0);
+    }
+    sm4_cipher.decrypt_blocks(enc.data(), dec.data(), n);
+    assert(dec == buf);
+    std::cout << "Test 3 - " << n << " blocks bulk encrypt/decrypt OK\n\n";
+
+    // 测试 4: 各优化实现与参考实现交叉校验
+    checkEngine<OptimizedSM4>("Test 4 - OptimizedSM4 (T-table)");
+    checkEngine<SM4_SIMD>("Test 5 - SM4_SIMD (" + std::string(SM4_SIMD::backendName()) + ")");
+    if (SM4_SIMD::hasAVX2()) checkKernel("         SM4_SIMD::cryptBlocksAVX2", SM4_SIMD::cryptBlocksAVX2);
+    if (SM4_SIMD::hasAVX512()) checkKernel("         SM4_SIMD::cryptBlocksAVX512", SM4_SIMD::cryptBlocksAVX512);
+    checkEngine<SM4_Bitsliced>("Test 6 - SM4_Bitsliced");
+    checkKernel("         SM4_Bitsliced::cryptFew", SM4_Bitsliced::cryptFew);
+    checkCTR();
+    checkGCM();
+    checkModes();
+    checkSerialThroughput();
+    checkXTS();
+    checkKeySchedule();
+    checkDispatch();
+    checkFileCipher();
+    std::cout << "\n";
+
+    std::cout << "所有测试通过！" << std::endl;
+    return 0;
+}
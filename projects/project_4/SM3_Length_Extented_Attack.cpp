@@ -1,5 +1,6 @@
 #include "sm3.h"
 #include <iostream>
+#include <iomanip>
 
 // 攻击者伪造的新数据
 std::string forgeExtension = "&admin=true";
@@ -17,37 +18,17 @@ std::vector<uint8_t> createPadding(size_t originalLen) {
     return pad;
 }
 
-// 利用原始哈希值和新数据构造新摘要
+// 利用原始哈希值和新数据构造新摘要：以原摘要为链接值，从 原消息 || 填充 之后继续压缩后缀
 std::vector<uint8_t> lengthExtensionAttack(const std::vector<uint8_t>& originalHash, size_t originalLen, const std::string& suffix) {
-    SM3 sm3;
     uint32_t H[8];
     for (int i = 0; i < 8; ++i) {
-        H[i] = (originalHash[4*i] << 24) | (originalHash[4*i + 1] << 16) |
-               (originalHash[4*i + 2] << 8) | originalHash[4*i + 3];
-    }
-
-    std::vector<uint8_t> forgedInput(suffix.begin(), suffix.end());
-    std::vector<uint8_t> padded;
-    sm3.pad(forgedInput, padded);
-
-    // 修改填充，使 total length = originalLen + padding + suffix
-    size_t fakeTotalLen = originalLen + createPadding(originalLen).size() + forgedInput.size();
-    std::vector<uint8_t> actualPadding = createPadding(fakeTotalLen - forgedInput.size());
-
-    // 重新压缩
-    size_t blocks = padded.size() / 64;
-    for (size_t i = 0; i < blocks; ++i) {
-        sm3.compress(H, padded.data() + i * 64);
+        H[i] = (uint32_t(originalHash[4*i]) << 24) | (uint32_t(originalHash[4*i + 1]) << 16) |
+               (uint32_t(originalHash[4*i + 2]) << 8) | originalHash[4*i + 3];
     }
 
-    std::vector<uint8_t> result(32);
-    for (int i = 0; i < 8; ++i) {
-        result[4*i]     = static_cast<uint8_t>(H[i] >> 24);
-        result[4*i + 1] = static_cast<uint8_t>(H[i] >> 16);
-        result[4*i + 2] = static_cast<uint8_t>(H[i] >> 8);
-        result[4*i + 3] = static_cast<uint8_t>(H[i]);
-    }
-    return result;
+    SM3::Context ctx(H, originalLen + createPadding(originalLen).size());
+    ctx.update(reinterpret_cast<const uint8_t*>(suffix.data()), suffix.size());
+    return ctx.final();
 }
 
 int main() {
@@ -61,4 +42,12 @@ int main() {
     std::cout << "\nForged Hash:   ";
     for (auto c : forgedHash) std::cout << std::hex << std::setw(2) << std::setfill('0') << (int)c;
     std::cout << std::endl;
+
+    // 验证：直接计算 原消息 || 填充 || 后缀 的摘要
+    std::vector<uint8_t> full(original.begin(), original.end());
+    std::vector<uint8_t> pad = createPadding(original.size());
+    full.insert(full.end(), pad.begin(), pad.end());
+    full.insert(full.end(), forgeExtension.begin(), forgeExtension.end());
+    std::cout << (SM3::hash(full) == forgedHash ? "Length extension succeeded" : "Length extension failed")
+              << std::endl;
 }
@@ -0,0 +1,138 @@
+#include "sm3.h"
+#include "sm3_mb.h"
+#include "sm3_simd.h"
+#include "sm3_otf.h"
+#include "unroll_sm3.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SM3_BENCH_TSC 1
+#include <x86intrin.h>
+#endif
+
+/*
+ * SM3 各实现性能对比
+ * 第一部分：64 B ~ 1 MB 的消息逐条哈希（含填充与输出）的 cycles/byte；
+ *           SM3_MB 一次提交同样长度的一批消息（总量约 1 MB），按总字节数折算。
+ * 第二部分：单条大消息的吞吐量（GB/s），输入从 1 MB 起每次放大 4 倍直到上限（默认 1024 MB），
+ *           同一块 16 MB 缓冲区反复喂给流式上下文，不需要真正分配 1 GB 内存。
+ * cycles/byte 按 TSC 计数计算，开启睿频时与核心周期有偏差；非 x86 平台改为输出 ns/byte。
+ * 用法: ./sm3_bench [最大 MB]
+ */
+
+static const size_t CHUNK = 16 * 1024 * 1024;
+
+static uint64_t tsc() {
+#ifdef SM3_BENCH_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/*
+ * 重复执行 run（每次处理 bytes 字节）至少 0.2 秒，返回每字节的 TSC 周期数（无 TSC 时为纳秒数）
+ */
+template <typename F>
+static double perByte(F&& run, size_t bytes) {
+    run(); // 预热
+    uint64_t iters = 0;
+    auto start = std::chrono::steady_clock::now();
+    uint64_t c0 = tsc();
+    double elapsed = 0;
+    do {
+        run();
+        ++iters;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < 0.2);
+    uint64_t cycles = tsc() - c0;
+#ifdef SM3_BENCH_TSC
+    return double(cycles) / (double(bytes) * iters);
+#else
+    (void)cycles;
+    return elapsed * 1e9 / (double(bytes) * iters);
+#endif
+}
+
+template <typename Impl>
+static double messageCost(const std::vector<uint8_t>& buf, size_t size) {
+    uint8_t digest[32];
+    return perByte([&] {
+        typename Impl::Context ctx;
+        ctx.update(buf.data(), size);
+        ctx.final(digest);
+    }, size);
+}
+
+static double batchCost(const std::vector<uint8_t>& buf, size_t size) {
+    size_t n = std::max<size_t>(16, (1 << 20) / size);
+    std::vector<const uint8_t*> ptrs(n);
+    std::vector<size_t> lens(n, size);
+    std::vector<uint8_t> digests(n * 32);
+    for (size_t i = 0; i < n; ++i) ptrs[i] = buf.data() + (i * size) % (buf.size() - size);
+    return perByte([&] { SM3_MB::hashMany(ptrs.data(), lens.data(), n, digests.data()); }, n * size);
+}
+
+template <typename Ctx>
+static double measureGBps(const std::vector<uint8_t>& buf, size_t total) {
+    auto run = [&] {
+        Ctx ctx;
+        for (size_t done = 0; done < total; done += CHUNK) {
+            ctx.update(buf.data(), std::min(CHUNK, total - done));
+        }
+        return ctx.final();
+    };
+    run(); // 预热
+    int iters = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    do {
+        run();
+        ++iters;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < 0.5);
+    return double(total) * iters / elapsed / 1e9;
+}
+
+int main(int argc, char** argv) {
+    size_t maxMb = argc > 1 ? std::stoul(argv[1]) : 1024;
+    std::vector<uint8_t> buf(CHUNK);
+    for (size_t i = 0; i < buf.size(); ++i) buf[i] = uint8_t(i * 31 + 7);
+
+#ifdef SM3_BENCH_TSC
+    const char* unit = "cycles/byte";
+#else
+    const char* unit = "ns/byte";
+#endif
+    std::cout << "SM3 per-message cost (" << unit << "), SM3_MB backend: " << SM3_MB::backendName() << "\n"
+              << std::setw(10) << "size" << std::setw(10) << "SM3" << std::setw(10) << "UNROLLED"
+              << std::setw(10) << "OTF" << std::setw(10) << "SIMD" << std::setw(10) << "MB" << "\n";
+    std::cout << std::fixed << std::setprecision(2);
+    for (size_t size : {64, 256, 1024, 4096, 65536, 1 << 20}) {
+        std::cout << std::setw(9) << size << "B"
+                  << std::setw(10) << messageCost<SM3>(buf, size)
+                  << std::setw(10) << messageCost<SM3_UNROLLED>(buf, size)
+                  << std::setw(10) << messageCost<SM3_OTF>(buf, size)
+                  << std::setw(10) << messageCost<SM3_SIMD>(buf, size)
+                  << std::setw(10) << batchCost(buf, size) << std::endl;
+    }
+
+    std::cout << "\nSM3 single-stream throughput (GB/s)\n"
+              << std::setw(10) << "size" << std::setw(12) << "SM3" << std::setw(12) << "UNROLLED"
+              << std::setw(12) << "OTF" << std::setw(12) << "SIMD" << "\n";
+    std::cout << std::setprecision(3);
+    for (size_t mb = 1; mb <= maxMb; mb *= 4) {
+        size_t total = mb * 1024 * 1024;
+        std::cout << std::setw(8) << mb << "MB"
+                  << std::setw(12) << measureGBps<SM3::Context>(buf, total)
+                  << std::setw(12) << measureGBps<SM3_UNROLLED::Context>(buf, total)
+                  << std::setw(12) << measureGBps<SM3_OTF::Context>(buf, total)
+                  << std::setw(12) << measureGBps<SM3_SIMD::Context>(buf, total) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include "sm3_hmac.h"
+#include "sm3.h"
+#include "sm3_mb.h"
+#include <cstring>
+
+using std::vector;
+
+namespace {
+
+// 防止编译器把清零优化掉
+void wipe(void* p, size_t n) {
+    volatile uint8_t* v = static_cast<volatile uint8_t*>(p);
+    while (n--) *v++ = 0;
+}
+
+} // namespace
+
+SM3_HMAC::SM3_HMAC(const uint8_t* key, size_t keyLen) {
+    uint8_t block[64] = {};
+    if (keyLen > sizeof(block)) {
+        SM3::Context ctx;
+        ctx.update(key, keyLen);
+        ctx.final(block);
+    } else if (keyLen) {
+        std::memcpy(block, key, keyLen);
+    }
+
+    for (auto& b : block) b ^= 0x36;
+    std::memcpy(inner, SM3_IV, sizeof(inner));
+    SM3::compressBlocks(inner, block, 1);
+
+    for (auto& b : block) b ^= 0x36 ^ 0x5c;
+    std::memcpy(outer, SM3_IV, sizeof(outer));
+    SM3::compressBlocks(outer, block, 1);
+
+    wipe(block, sizeof(block));
+}
+
+SM3_HMAC::SM3_HMAC(const vector<uint8_t>& key) : SM3_HMAC(key.data(), key.size()) {}
+
+SM3_HMAC::~SM3_HMAC() {
+    wipe(inner, sizeof(inner));
+    wipe(outer, sizeof(outer));
+}
+
+void SM3_HMAC::mac(const uint8_t* msg, size_t len, uint8_t out[MAC_SIZE]) const {
+    uint8_t digest[32];
+    SM3::Context inCtx(inner, 64);
+    inCtx.update(msg, len);
+    inCtx.final(digest);
+    SM3::Context outCtx(outer, 64);
+    outCtx.update(digest, sizeof(digest));
+    outCtx.final(out);
+}
+
+vector<uint8_t> SM3_HMAC::mac(const uint8_t* msg, size_t len) const {
+    vector<uint8_t> out(MAC_SIZE);
+    mac(msg, len, out.data());
+    return out;
+}
+
+vector<uint8_t> SM3_HMAC::mac(const vector<uint8_t>& msg) const {
+    return mac(msg.data(), msg.size());
+}
+
+bool SM3_HMAC::verify(const uint8_t* msg, size_t len, const uint8_t tag[MAC_SIZE]) const {
+    uint8_t expected[MAC_SIZE];
+    mac(msg, len, expected);
+    uint8_t diff = 0;
+    for (size_t i = 0; i < MAC_SIZE; ++i) diff |= uint8_t(expected[i] ^ tag[i]);
+    return diff == 0;
+}
+
+void SM3_HMAC::macMany(const uint8_t* const* msgs, const size_t* lens, size_t n, uint8_t* macs) const {
+    // 内层：各消息接在 K ⊕ ipad 之后
+    vector<uint8_t> digests(n * 32);
+    SM3_MB::hashMany(inner, 64, msgs, lens, n, digests.data());
+    // 外层：每条都是 32 字节的内层摘要，恰好一个填充分组
+    vector<const uint8_t*> ptrs(n);
+    vector<size_t> sizes(n, 32);
+    for (size_t i = 0; i < n; ++i) ptrs[i] = digests.data() + i * 32;
+    SM3_MB::hashMany(outer, 64, ptrs.data(), sizes.data(), n, macs);
+}
+
+vector<vector<uint8_t>> SM3_HMAC::macMany(const vector<vector<uint8_t>>& msgs) const {
+    size_t n = msgs.size();
+    vector<const uint8_t*> ptrs(n);
+    vector<size_t> lens(n);
+    for (size_t i = 0; i < n; ++i) {
+        ptrs[i] = msgs[i].data();
+        lens[i] = msgs[i].size();
+    }
+    vector<uint8_t> flat(n * MAC_SIZE);
+    macMany(ptrs.data(), lens.data(), n, flat.data());
+    vector<vector<uint8_t>> out(n);
+    for (size_t i = 0; i < n; ++i) {
+        out[i].assign(flat.begin() + i * MAC_SIZE, flat.begin() + (i + 1) * MAC_SIZE);
+    }
+    return out;
+}
+
+vector<uint8_t> SM3_HMAC::mac(const uint8_t* key, size_t keyLen, const uint8_t* msg, size_t len) {
+    return SM3_HMAC(key, keyLen).mac(msg, len);
+}
@@ -0,0 +1,46 @@
+#ifndef SM3_HMAC_H
+#define SM3_HMAC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * SM3_HMAC
+ * HMAC-SM3（GB/T 15852.2 / RFC 2104）：HMAC(K, m) = SM3((K ⊕ opad) || SM3((K ⊕ ipad) || m))
+ * K ⊕ ipad 与 K ⊕ opad 各自恰好一个分组，构造时压缩一次并缓存链接值，
+ * 之后每条消息只需压缩自身的分组、内层填充和外层的一个分组，不再重复处理密钥。
+ * macMany 在同一密钥下批量计算，内外两层都交给多缓冲内核（SM3_MB）。
+ * 对象构造后只读，可在多个线程间共享。
+ */
+class SM3_HMAC {
+public:
+    static constexpr size_t MAC_SIZE = 32;
+
+    // 密钥长于 64 字节时先做 SM3
+    SM3_HMAC(const uint8_t* key, size_t keyLen);
+    explicit SM3_HMAC(const std::vector<uint8_t>& key);
+    ~SM3_HMAC();
+
+    void mac(const uint8_t* msg, size_t len, uint8_t out[MAC_SIZE]) const;
+    std::vector<uint8_t> mac(const uint8_t* msg, size_t len) const;
+    std::vector<uint8_t> mac(const std::vector<uint8_t>& msg) const;
+
+    // 常数时间比较标签
+    bool verify(const uint8_t* msg, size_t len, const uint8_t tag[MAC_SIZE]) const;
+
+    /*
+     * 批量计算 n 条消息的 MAC，macs 连续存放 n×32 字节
+     */
+    void macMany(const uint8_t* const* msgs, const size_t* lens, size_t n, uint8_t* macs) const;
+    std::vector<std::vector<uint8_t>> macMany(const std::vector<std::vector<uint8_t>>& msgs) const;
+
+    // 一次性接口
+    static std::vector<uint8_t> mac(const uint8_t* key, size_t keyLen, const uint8_t* msg, size_t len);
+
+private:
+    uint32_t inner[8];   // 压缩 K ⊕ ipad 之后的链接值
+    uint32_t outer[8];   // 压缩 K ⊕ opad 之后的链接值
+};
+
+#endif // SM3_HMAC_H
@@ -0,0 +1,462 @@
+#include "sm3_mb.h"
+#include "sm3.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SM3_MB_X86 1
+#include <immintrin.h>
+#endif
+
+using std::vector;
+
+namespace {
+
+// 单步最多推进的分组数，空闲通道从 STEP_BLOCKS 个全零分组读取
+constexpr size_t STEP_BLOCKS = 16;
+alignas(64) const uint8_t ZERO_BLOCKS[STEP_BLOCKS * 64] = {};
+
+inline void storeDigest(uint8_t out[32], const uint32_t H[8]) {
+    for (int i = 0; i < 8; ++i) {
+        out[4*i    ] = uint8_t(H[i] >> 24);
+        out[4*i + 1] = uint8_t(H[i] >> 16);
+        out[4*i + 2] = uint8_t(H[i] >> 8);
+        out[4*i + 3] = uint8_t(H[i]);
+    }
+}
+
+#ifdef SM3_MB_X86
+
+alignas(32) const uint8_t BSWAP32[32] = {
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+};
+
+/* ---------------- AVX2：8 路 ---------------- */
+
+#define SM3_AVX2 __attribute__((target("avx2")))
+
+template <int N>
+SM3_AVX2 inline __m256i rotl8(__m256i x) {
+    return _mm256_or_si256(_mm256_slli_epi32(x, N), _mm256_srli_epi32(x, 32 - N));
+}
+
+SM3_AVX2 inline __m256i xor3(__m256i a, __m256i b, __m256i c) {
+    return _mm256_xor_si256(_mm256_xor_si256(a, b), c);
+}
+
+/*
+ * 8×8 的 32 位字转置：r[l] 是第 l 路的 8 个字，转置后 r[j] 是各路的第 j 个字
+ */
+SM3_AVX2 inline void transpose8(__m256i r[8]) {
+    __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]), t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]), t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]), t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]), t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2), u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3), u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6), u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7), u7 = _mm256_unpackhi_epi64(t5, t7);
+    r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+    r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+    r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+    r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+    r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+    r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+    r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+    r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+/*
+ * 一轮迭代；Late 表示第 16~63 轮，FF/GG 的两个阶段在编译期选定，轮内没有分支
+ */
+template <bool Late>
+SM3_AVX2 inline void roundAVX2(__m256i& A, __m256i& B, __m256i& C, __m256i& D,
+                               __m256i& E, __m256i& F, __m256i& G, __m256i& H,
+                               __m256i w, __m256i w4, uint32_t k) {
+    __m256i a12 = rotl8<12>(A);
+    __m256i SS1 = rotl8<7>(_mm256_add_epi32(_mm256_add_epi32(a12, E), _mm256_set1_epi32(int(k))));
+    __m256i SS2 = _mm256_xor_si256(SS1, a12);
+    __m256i ff, gg;
+    if (Late) {
+        ff = _mm256_or_si256(_mm256_and_si256(A, B), _mm256_and_si256(C, _mm256_or_si256(A, B)));
+        gg = _mm256_or_si256(_mm256_and_si256(E, F), _mm256_andnot_si256(E, G));
+    } else {
+        ff = xor3(A, B, C);
+        gg = xor3(E, F, G);
+    }
+    __m256i TT1 = _mm256_add_epi32(_mm256_add_epi32(ff, D), _mm256_add_epi32(SS2, _mm256_xor_si256(w, w4)));
+    __m256i TT2 = _mm256_add_epi32(_mm256_add_epi32(gg, H), _mm256_add_epi32(SS1, w));
+    D = C;
+    C = rotl8<9>(B);
+    B = A;
+    A = TT1;
+    H = G;
+    G = rotl8<19>(F);
+    F = E;
+    E = xor3(TT2, rotl8<9>(TT2), rotl8<17>(TT2));
+}
+
+SM3_AVX2 void compressAVX2(uint32_t state[8][8], const uint8_t* const data[8], size_t nblocks) {
+    const __m256i bswap = _mm256_load_si256(reinterpret_cast<const __m256i*>(BSWAP32));
+    __m256i V[8];
+    for (int i = 0; i < 8; ++i) V[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[i]));
+
+    for (size_t b = 0; b < nblocks; ++b) {
+        __m256i W[68];
+        for (int l = 0; l < 8; ++l) {
+            const uint8_t* p = data[l] + b * 64;
+            W[l]     = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), bswap);
+            W[l + 8] = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32)), bswap);
+        }
+        transpose8(W);
+        transpose8(W + 8);
+        for (int j = 16; j < 68; ++j) {
+            __m256i t = xor3(W[j-16], W[j-9], rotl8<15>(W[j-3]));
+            t = xor3(t, rotl8<15>(t), rotl8<23>(t));
+            W[j] = xor3(t, rotl8<7>(W[j-13]), W[j-6]);
+        }
+
+        __m256i A = V[0], B = V[1], C = V[2], D = V[3];
+        __m256i E = V[4], F = V[5], G = V[6], H = V[7];
+        for (int j = 0; j < 16; ++j) roundAVX2<false>(A, B, C, D, E, F, G, H, W[j], W[j+4], SM3_T_ROT[j]);
+        for (int j = 16; j < 64; ++j) roundAVX2<true>(A, B, C, D, E, F, G, H, W[j], W[j+4], SM3_T_ROT[j]);
+        V[0] = _mm256_xor_si256(V[0], A); V[1] = _mm256_xor_si256(V[1], B);
+        V[2] = _mm256_xor_si256(V[2], C); V[3] = _mm256_xor_si256(V[3], D);
+        V[4] = _mm256_xor_si256(V[4], E); V[5] = _mm256_xor_si256(V[5], F);
+        V[6] = _mm256_xor_si256(V[6], G); V[7] = _mm256_xor_si256(V[7], H);
+    }
+    for (int i = 0; i < 8; ++i) _mm256_storeu_si256(reinterpret_cast<__m256i*>(state[i]), V[i]);
+}
+
+/* ---------------- AVX-512：16 路 ---------------- */
+
+#define SM3_AVX512 __attribute__((target("avx512f,avx512bw")))
+
+/*
+ * 16×16 的 32 位字转置：先在每个 128 位通道内做 4×4 转置，再用 shuffle_i32x4 交换 128 位通道
+ */
+SM3_AVX512 inline void transpose16(__m512i r[16]) {
+    __m512i t[16], u[16];
+    for (int k = 0; k < 8; ++k) {
+        t[2*k]     = _mm512_unpacklo_epi32(r[2*k], r[2*k + 1]);
+        t[2*k + 1] = _mm512_unpackhi_epi32(r[2*k], r[2*k + 1]);
+    }
+    // u[4g + c] 的第 q 个 128 位通道 = 第 4g..4g+3 路的第 4q + c 个字
+    for (int g = 0; g < 4; ++g) {
+        u[4*g]     = _mm512_unpacklo_epi64(t[4*g],     t[4*g + 2]);
+        u[4*g + 1] = _mm512_unpackhi_epi64(t[4*g],     t[4*g + 2]);
+        u[4*g + 2] = _mm512_unpacklo_epi64(t[4*g + 1], t[4*g + 3]);
+        u[4*g + 3] = _mm512_unpackhi_epi64(t[4*g + 1], t[4*g + 3]);
+    }
+    for (int c = 0; c < 4; ++c) {
+        __m512i v0 = _mm512_shuffle_i32x4(u[c],     u[4 + c],  0x44);
+        __m512i v1 = _mm512_shuffle_i32x4(u[c],     u[4 + c],  0xEE);
+        __m512i v2 = _mm512_shuffle_i32x4(u[8 + c], u[12 + c], 0x44);
+        __m512i v3 = _mm512_shuffle_i32x4(u[8 + c], u[12 + c], 0xEE);
+        r[c]      = _mm512_shuffle_i32x4(v0, v2, 0x88);
+        r[4 + c]  = _mm512_shuffle_i32x4(v0, v2, 0xDD);
+        r[8 + c]  = _mm512_shuffle_i32x4(v1, v3, 0x88);
+        r[12 + c] = _mm512_shuffle_i32x4(v1, v3, 0xDD);
+    }
+}
+
+// 三输入布尔函数用 VPTERNLOGD 一条指令完成：0x96 = x⊕y⊕z，0xE8 = 多数函数，0xCA = x ? y : z
+#define XOR3_512(a, b, c) _mm512_ternarylogic_epi32(a, b, c, 0x96)
+
+template <bool Late>
+SM3_AVX512 inline void roundAVX512(__m512i& A, __m512i& B, __m512i& C, __m512i& D,
+                                   __m512i& E, __m512i& F, __m512i& G, __m512i& H,
+                                   __m512i w, __m512i w4, uint32_t k) {
+    __m512i a12 = _mm512_rol_epi32(A, 12);
+    __m512i SS1 = _mm512_rol_epi32(_mm512_add_epi32(_mm512_add_epi32(a12, E), _mm512_set1_epi32(int(k))), 7);
+    __m512i SS2 = _mm512_xor_si512(SS1, a12);
+    __m512i ff = Late ? _mm512_ternarylogic_epi32(A, B, C, 0xE8) : XOR3_512(A, B, C);
+    __m512i gg = Late ? _mm512_ternarylogic_epi32(E, F, G, 0xCA) : XOR3_512(E, F, G);
+    __m512i TT1 = _mm512_add_epi32(_mm512_add_epi32(ff, D), _mm512_add_epi32(SS2, _mm512_xor_si512(w, w4)));
+    __m512i TT2 = _mm512_add_epi32(_mm512_add_epi32(gg, H), _mm512_add_epi32(SS1, w));
+    D = C;
+    C = _mm512_rol_epi32(B, 9);
+    B = A;
+    A = TT1;
+    H = G;
+    G = _mm512_rol_epi32(F, 19);
+    F = E;
+    E = XOR3_512(TT2, _mm512_rol_epi32(TT2, 9), _mm512_rol_epi32(TT2, 17));
+}
+
+SM3_AVX512 void compressAVX512(uint32_t state[8][16], const uint8_t* const data[16], size_t nblocks) {
+    const __m512i bswap = _mm512_broadcast_i32x4(_mm_load_si128(reinterpret_cast<const __m128i*>(BSWAP32)));
+    __m512i V[8];
+    for (int i = 0; i < 8; ++i) V[i] = _mm512_loadu_si512(state[i]);
+
+    for (size_t b = 0; b < nblocks; ++b) {
+        __m512i W[68];
+        for (int l = 0; l < 16; ++l) {
+            W[l] = _mm512_shuffle_epi8(_mm512_loadu_si512(data[l] + b * 64), bswap);
+        }
+        transpose16(W);
+        for (int j = 16; j < 68; ++j) {
+            __m512i t = XOR3_512(W[j-16], W[j-9], _mm512_rol_epi32(W[j-3], 15));
+            t = XOR3_512(t, _mm512_rol_epi32(t, 15), _mm512_rol_epi32(t, 23));
+            W[j] = XOR3_512(t, _mm512_rol_epi32(W[j-13], 7), W[j-6]);
+        }
+
+        __m512i A = V[0], B = V[1], C = V[2], D = V[3];
+        __m512i E = V[4], F = V[5], G = V[6], H = V[7];
+        for (int j = 0; j < 16; ++j) roundAVX512<false>(A, B, C, D, E, F, G, H, W[j], W[j+4], SM3_T_ROT[j]);
+        for (int j = 16; j < 64; ++j) roundAVX512<true>(A, B, C, D, E, F, G, H, W[j], W[j+4], SM3_T_ROT[j]);
+        V[0] = _mm512_xor_si512(V[0], A); V[1] = _mm512_xor_si512(V[1], B);
+        V[2] = _mm512_xor_si512(V[2], C); V[3] = _mm512_xor_si512(V[3], D);
+        V[4] = _mm512_xor_si512(V[4], E); V[5] = _mm512_xor_si512(V[5], F);
+        V[6] = _mm512_xor_si512(V[6], G); V[7] = _mm512_xor_si512(V[7], H);
+    }
+    for (int i = 0; i < 8; ++i) _mm512_storeu_si512(state[i], V[i]);
+}
+
+#undef XOR3_512
+
+#endif // SM3_MB_X86
+
+/*
+ * L 路调度器
+ * 每路的数据是两段：消息中的完整分组（seg = 0）与本地填充好的尾部分组（seg = 1）。
+ * 每一步推进 min(各活动通道当前段剩余分组数, STEP_BLOCKS) 个分组，空闲通道读全零分组、结果丢弃。
+ */
+template <size_t L>
+class Scheduler {
+public:
+    typedef void (*Kernel)(uint32_t state[8][L], const uint8_t* const data[L], size_t nblocks);
+
+    Scheduler(Kernel kernel, const uint32_t iv[8], uint64_t prefix)
+        : kernel(kernel), iv(iv), prefix(prefix) {}
+
+    void run(const uint8_t* const* msgs, const size_t* lens, size_t n, uint8_t* digests) {
+        size_t next = 0, active = 0;
+        for (size_t l = 0; l < L; ++l) {
+            lanes[l].active = false;
+            if (next < n) {
+                load(l, next, msgs[next], lens[next]);
+                ++next;
+                ++active;
+            }
+        }
+
+        while (active) {
+            // 只剩少数通道时向量核心的大部分通道在空转，改用标量压缩收尾
+            if (next == n && active * 4 < L) {
+                for (size_t l = 0; l < L; ++l) {
+                    if (lanes[l].active) finishScalar(l, digests);
+                }
+                return;
+            }
+
+            size_t step = STEP_BLOCKS;
+            for (size_t l = 0; l < L; ++l) {
+                if (lanes[l].active) step = std::min(step, lanes[l].blocks);
+            }
+            const uint8_t* ptrs[L];
+            for (size_t l = 0; l < L; ++l) {
+                ptrs[l] = lanes[l].active ? lanes[l].ptr : ZERO_BLOCKS;
+            }
+            kernel(state, ptrs, step);
+
+            for (size_t l = 0; l < L; ++l) {
+                Lane& ln = lanes[l];
+                if (!ln.active) continue;
+                ln.ptr += step * 64;
+                ln.blocks -= step;
+                if (ln.blocks) continue;
+                if (!ln.inTail) {
+                    ln.inTail = true;
+                    ln.ptr = ln.tail;
+                    ln.blocks = ln.tailBlocks;
+                    continue;
+                }
+                uint32_t H[8];
+                for (int i = 0; i < 8; ++i) H[i] = state[i][l];
+                storeDigest(digests + ln.job * 32, H);
+                ln.active = false;
+                --active;
+                if (next < n) {
+                    load(l, next, msgs[next], lens[next]);
+                    ++next;
+                    ++active;
+                }
+            }
+        }
+    }
+
+private:
+    struct Lane {
+        size_t job;
+        const uint8_t* ptr;
+        size_t blocks;       // 当前段剩余分组数
+        size_t tailBlocks;
+        bool inTail;
+        bool active;
+        uint8_t tail[128];
+    };
+
+    void load(size_t l, size_t job, const uint8_t* msg, size_t len) {
+        Lane& ln = lanes[l];
+        ln.job = job;
+        ln.active = true;
+        for (int i = 0; i < 8; ++i) state[i][l] = iv[i];
+
+        size_t full = len / 64, rem = len % 64;
+        if (rem) std::memcpy(ln.tail, msg + full * 64, rem);
+        ln.tail[rem] = 0x80;
+        ln.tailBlocks = rem + 9 <= 64 ? 1 : 2;
+        size_t end = ln.tailBlocks * 64;
+        std::memset(ln.tail + rem + 1, 0, end - 8 - rem - 1);
+        uint64_t bitLen = (prefix + len) * 8;
+        for (int i = 0; i < 8; ++i) {
+            ln.tail[end - 8 + i] = uint8_t(bitLen >> (56 - 8 * i));
+        }
+
+        if (full) {
+            ln.inTail = false;
+            ln.ptr = msg;
+            ln.blocks = full;
+        } else {
+            ln.inTail = true;
+            ln.ptr = ln.tail;
+            ln.blocks = ln.tailBlocks;
+        }
+    }
+
+    void finishScalar(size_t l, uint8_t* digests) {
+        Lane& ln = lanes[l];
+        uint32_t H[8];
+        for (int i = 0; i < 8; ++i) H[i] = state[i][l];
+        SM3::compressBlocks(H, ln.ptr, ln.blocks);
+        if (!ln.inTail) SM3::compressBlocks(H, ln.tail, ln.tailBlocks);
+        storeDigest(digests + ln.job * 32, H);
+        ln.active = false;
+    }
+
+    Kernel kernel;
+    const uint32_t* iv;
+    uint64_t prefix;
+    alignas(64) uint32_t state[8][L];
+    Lane lanes[L];
+};
+
+void hashManyFrom(const uint32_t iv[8], uint64_t prefix,
+                  const uint8_t* const* msgs, const size_t* lens, size_t n, uint8_t* digests) {
+    if (n == 0) return;
+    size_t lanes = SM3_MB::lanes();
+    if (lanes == 16 && n >= 4) {
+        Scheduler<16>(SM3_MB::compress16, iv, prefix).run(msgs, lens, n, digests);
+    } else if (lanes >= 8 && n >= 2) {
+        Scheduler<8>(SM3_MB::compress8, iv, prefix).run(msgs, lens, n, digests);
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            SM3::Context ctx(iv, prefix);
+            ctx.update(msgs[i], lens[i]);
+            ctx.final(digests + i * 32);
+        }
+    }
+}
+
+} // namespace
+
+#ifdef SM3_MB_X86
+
+bool SM3_MB::hasAVX2() {
+    static const bool ok = __builtin_cpu_supports("avx2");
+    return ok;
+}
+
+bool SM3_MB::hasAVX512() {
+    static const bool ok = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+    return ok;
+}
+
+void SM3_MB::compress8(uint32_t state[8][8], const uint8_t* const data[8], size_t nblocks) {
+    compressAVX2(state, data, nblocks);
+}
+
+void SM3_MB::compress16(uint32_t state[8][16], const uint8_t* const data[16], size_t nblocks) {
+    compressAVX512(state, data, nblocks);
+}
+
+#else // !SM3_MB_X86
+
+bool SM3_MB::hasAVX2() { return false; }
+bool SM3_MB::hasAVX512() { return false; }
+
+// 没有向量指令时逐路调用标量压缩函数，保持接口可用
+void SM3_MB::compress8(uint32_t state[8][8], const uint8_t* const data[8], size_t nblocks) {
+    for (int l = 0; l < 8; ++l) {
+        uint32_t H[8];
+        for (int i = 0; i < 8; ++i) H[i] = state[i][l];
+        SM3::compressBlocks(H, data[l], nblocks);
+        for (int i = 0; i < 8; ++i) state[i][l] = H[i];
+    }
+}
+
+void SM3_MB::compress16(uint32_t state[8][16], const uint8_t* const data[16], size_t nblocks) {
+    for (int l = 0; l < 16; ++l) {
+        uint32_t H[8];
+        for (int i = 0; i < 8; ++i) H[i] = state[i][l];
+        SM3::compressBlocks(H, data[l], nblocks);
+        for (int i = 0; i < 8; ++i) state[i][l] = H[i];
+    }
+}
+
+#endif // SM3_MB_X86
+
+/*
+ * 环境变量 SM3_MB_BACKEND=avx512|avx2|scalar 可强制降级（测试与对比性能用），
+ * 请求的指令集不受支持时仍按 CPU 能力选择
+ */
+size_t SM3_MB::lanes() {
+    static const size_t n = [] {
+        const char* env = std::getenv("SM3_MB_BACKEND");
+        std::string want = env ? env : "";
+        if (want == "scalar") return size_t(1);
+        if (want == "avx2" && hasAVX2()) return size_t(8);
+        if (hasAVX512()) return size_t(16);
+        if (hasAVX2()) return size_t(8);
+        return size_t(1);
+    }();
+    return n;
+}
+
+const char* SM3_MB::backendName() {
+    switch (lanes()) {
+    case 16: return "avx512x16";
+    case 8:  return "avx2x8";
+    default: return "scalar";
+    }
+}
+
+void SM3_MB::hashMany(const uint8_t* const* msgs, const size_t* lens, size_t n, uint8_t* digests) {
+    hashManyFrom(SM3_IV, 0, msgs, lens, n, digests);
+}
+
+void SM3_MB::hashMany(const uint32_t H0[8], uint64_t prefixLen,
+                      const uint8_t* const* msgs, const size_t* lens, size_t n, uint8_t* digests) {
+    hashManyFrom(H0, prefixLen, msgs, lens, n, digests);
+}
+
+vector<vector<uint8_t>> SM3_MB::hashMany(const vector<vector<uint8_t>>& msgs) {
+    size_t n = msgs.size();
+    vector<const uint8_t*> ptrs(n);
+    vector<size_t> lens(n);
+    for (size_t i = 0; i < n; ++i) {
+        ptrs[i] = msgs[i].data();
+        lens[i] = msgs[i].size();
+    }
+    vector<uint8_t> flat(n * DIGEST_SIZE);
+    hashMany(ptrs.data(), lens.data(), n, flat.data());
+    vector<vector<uint8_t>> out(n);
+    for (size_t i = 0; i < n; ++i) {
+        out[i].assign(flat.begin() + i * DIGEST_SIZE, flat.begin() + (i + 1) * DIGEST_SIZE);
+    }
+    return out;
+}
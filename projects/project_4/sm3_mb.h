@@ -0,0 +1,55 @@
+#ifndef SM3_MB_H
+#define SM3_MB_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * SM3_MB
+ * 多缓冲（multi-buffer）SM3：单条消息的 64 轮迭代是严格串行的，但互不相关的消息之间没有依赖。
+ * 把 8 条（AVX2）或 16 条（AVX-512）消息放在向量寄存器的不同 32 位通道里，
+ * 一次压缩调用同时推进所有通道，适合 Merkle 叶子、口令检查标识符等大量短消息。
+ *
+ * 调度器 hashMany 负责把长度不一的消息分配到通道：
+ *   - 每个通道的数据分两段：消息中的完整分组（直接从调用者的缓冲区读取）与填充后的尾部 1~2 个分组；
+ *   - 每一步按各通道当前段剩余分组数的最小值推进，某个通道的消息结束后立即装入下一条消息；
+ *   - 待处理消息耗尽、活动通道不足四分之一时，剩余通道改用标量压缩函数收尾。
+ * 运行时检测 CPU，不支持 AVX2 时退化为逐条调用 SM3；环境变量 SM3_MB_BACKEND 可强制选择后端。
+ */
+class SM3_MB {
+public:
+    static constexpr size_t DIGEST_SIZE = 32;
+
+    /*
+     * 计算 n 条消息的摘要
+     * @param msgs / lens: 第 i 条消息的起始地址与字节数
+     * @param digests: 输出，连续存放 n 个 32 字节摘要
+     */
+    static void hashMany(const uint8_t* const* msgs, const size_t* lens, size_t n, uint8_t* digests);
+    static std::vector<std::vector<uint8_t>> hashMany(const std::vector<std::vector<uint8_t>>& msgs);
+
+    /*
+     * 从链接值 H0 继续计算：相当于对 前缀 || msgs[i] 求摘要，前缀已压缩进 H0
+     * @param prefixLen: 前缀字节数（64 的倍数），计入填充中的消息长度
+     * 用于域分离的树哈希、HMAC 的内外层等共享前缀的场景
+     */
+    static void hashMany(const uint32_t H0[8], uint64_t prefixLen,
+                         const uint8_t* const* msgs, const size_t* lens, size_t n, uint8_t* digests);
+
+    /*
+     * 多路压缩核心：state[i][l] 是第 l 路的第 i 个链接字（按字存放，便于整列载入向量寄存器）
+     * 第 l 路依次压缩 data[l] 起的 nblocks 个连续分组，调用前需确认 CPU 支持
+     */
+    static void compress8(uint32_t state[8][8], const uint8_t* const data[8], size_t nblocks);
+    static void compress16(uint32_t state[8][16], const uint8_t* const data[16], size_t nblocks);
+
+    // 当前 CPU 上的通道数（16、8 或 1）与后端名称
+    static size_t lanes();
+    static const char* backendName();
+
+    static bool hasAVX2();
+    static bool hasAVX512();   // AVX-512F + AVX-512BW
+};
+
+#endif // SM3_MB_H
@@ -1,94 +1,554 @@
+#include "sm3_merkle.h"
 #include "sm3.h"
-#include <iostream>
-#include <vector>
-#include <cmath>
-#include <string>
-#include <sstream>
-
-// Merkle Tree 节点
-struct MerkleNode {
-    std::vector<uint8_t> hash;
-    MerkleNode* left = nullptr;
-    MerkleNode* right = nullptr;
-};
-
-// 计算哈希
-std::vector<uint8_t> calcHash(const std::string& data) {
-    SM3 sm3;
-    return sm3.hash(std::vector<uint8_t>(data.begin(), data.end()));
-}
-
-// 合并两个哈希
-std::vector<uint8_t> mergeHash(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
-    std::vector<uint8_t> concat = a;
-    concat.insert(concat.end(), b.begin(), b.end());
-    return calcHash(std::string(concat.begin(), concat.end()));
-}
-
-// 构造 Merkle 树
-MerkleNode* buildMerkleTree(std::vector<MerkleNode*>& leaves) {
-    std::vector<MerkleNode*> current = leaves;
-    while (current.size() > 1) {
-        std::vector<MerkleNode*> next;
-        for (size_t i = 0; i < current.size(); i += 2) {
-            MerkleNode* left = current[i];
-            MerkleNode* right = (i + 1 < current.size()) ? current[i + 1] : nullptr;
-            MerkleNode* parent = new MerkleNode;
-            parent->left = left;
-            parent->right = right;
-            if (right)
-                parent->hash = mergeHash(left->hash, right->hash);
-            else
-                parent->hash = mergeHash(left->hash, left->hash);
-            next.push_back(parent);
+#include "sm3_mb.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+using std::vector;
+
+static_assert(sizeof(SM3MerkleTree::Digest) == SM3MerkleTree::DIGEST_SIZE, "Digest must be packed");
+
+namespace {
+
+// 小于 n 的最大的 2 的幂（n ≥ 2）
+uint64_t splitPoint(uint64_t n) {
+    uint64_t k = 1;
+    while (k << 1 < n) k <<= 1;
+    return k;
+}
+
+// 每个任务至少处理的叶子数与父节点数；更小的工作量直接在调用线程上完成
+const size_t LEAF_GROUP = 1024;
+const size_t NODE_GROUP = 2048;
+// 叶子加上 0x00 前缀后分批拷入暂存区，每批交给 SM3_MB::hashMany 的消息数
+const size_t LEAF_BATCH = 64;
+
+void putBE32(uint8_t* p, uint32_t v) {
+    p[0] = uint8_t(v >> 24);
+    p[1] = uint8_t(v >> 16);
+    p[2] = uint8_t(v >> 8);
+    p[3] = uint8_t(v);
+}
+
+/*
+ * 父节点的输入 0x01 || 左 || 右 共 65 字节，填充后恰好 2 个分组：
+ * 第 65 字节为 0x80，末尾 8 字节为比特长度 520。每路只需拷入 64 字节孩子摘要。
+ */
+void initParentBlocks(uint8_t blocks[128]) {
+    std::memset(blocks, 0, 128);
+    blocks[0] = 0x01;
+    blocks[65] = 0x80;
+    blocks[126] = 0x02;
+    blocks[127] = 0x08;
+}
+
+// 用 L 路压缩核心计算 count 个父节点，children 为下一层中连续的 2 × count 个摘要
+template <size_t L>
+void hashParentsMB(void (*kernel)(uint32_t (*)[L], const uint8_t* const*, size_t),
+                   const SM3MerkleTree::Digest* children, size_t count, SM3MerkleTree::Digest* out) {
+    alignas(64) uint8_t blocks[L][128];
+    const uint8_t* data[L];
+    for (size_t l = 0; l < L; ++l) {
+        initParentBlocks(blocks[l]);
+        data[l] = blocks[l];
+    }
+    size_t i = 0;
+    for (; i + L <= count; i += L) {
+        uint32_t state[8][L];
+        for (int w = 0; w < 8; ++w) {
+            for (size_t l = 0; l < L; ++l) state[w][l] = SM3_IV[w];
+        }
+        for (size_t l = 0; l < L; ++l) std::memcpy(blocks[l] + 1, children[2 * (i + l)].data(), 64);
+        kernel(state, data, 2);
+        for (size_t l = 0; l < L; ++l) {
+            for (int w = 0; w < 8; ++w) putBE32(out[i + l].data() + 4 * w, state[w][l]);
         }
-        current = next;
     }
-    return current.front();
+    for (; i < count; ++i) out[i] = SM3MerkleTree::hashNode(children[2 * i], children[2 * i + 1]);
+}
+
+void hashParents(const SM3MerkleTree::Digest* children, size_t count, SM3MerkleTree::Digest* out) {
+    switch (SM3_MB::lanes()) {
+    case 16:
+        hashParentsMB<16>(SM3_MB::compress16, children, count, out);
+        break;
+    case 8:
+        hashParentsMB<8>(SM3_MB::compress8, children, count, out);
+        break;
+    default:
+        for (size_t i = 0; i < count; ++i) out[i] = SM3MerkleTree::hashNode(children[2 * i], children[2 * i + 1]);
+    }
+}
+
+/*
+ * 计算第 begin ~ end-1 条记录的叶子摘要，record(i) 返回第 i 条记录的 {地址, 长度}
+ * 0x00 前缀使记录在分组中错开一个字节，无法就地读取，按批拷入暂存区
+ */
+template <typename Record>
+void hashLeaves(const Record& record, size_t begin, size_t end, SM3MerkleTree::Digest* out) {
+    vector<uint8_t> scratch;
+    const uint8_t* ptrs[LEAF_BATCH];
+    size_t lens[LEAF_BATCH];
+    for (size_t i = begin; i < end; i += LEAF_BATCH) {
+        size_t m = std::min(LEAF_BATCH, end - i), total = 0;
+        for (size_t j = 0; j < m; ++j) total += 1 + record(i + j).second;
+        scratch.resize(total);
+        uint8_t* p = scratch.data();
+        for (size_t j = 0; j < m; ++j) {
+            std::pair<const uint8_t*, size_t> r = record(i + j);
+            ptrs[j] = p;
+            lens[j] = 1 + r.second;
+            *p++ = 0x00;
+            if (r.second) std::memcpy(p, r.first, r.second);
+            p += r.second;
+        }
+        SM3_MB::hashMany(ptrs, lens, m, out[i - begin].data());
+    }
+}
+
+// 空树的根 SM3("")
+const SM3MerkleTree::Digest& emptyRoot() {
+    static const SM3MerkleTree::Digest empty = [] {
+        SM3MerkleTree::Digest d;
+        SM3::Context().final(d.data());
+        return d;
+    }();
+    return empty;
+}
+
+} // namespace
+
+SM3MerkleTree::SM3MerkleTree(vector<Digest> leaves, ThreadPool* pool) : pool(pool) {
+    build(std::move(leaves));
+}
+
+SM3MerkleTree::Digest SM3MerkleTree::hashLeaf(const uint8_t* data, size_t len) {
+    static const uint8_t prefix = 0x00;
+    Digest d;
+    SM3::Context ctx;
+    ctx.update(&prefix, 1);
+    ctx.update(data, len);
+    ctx.final(d.data());
+    return d;
 }
 
-// 构造包含证明
-void generateInclusionProof(MerkleNode* node, const std::vector<uint8_t>& targetHash, std::vector<std::vector<uint8_t>>& proof) {
-    if (!node->left && !node->right)
+SM3MerkleTree::Digest SM3MerkleTree::hashLeaf(const std::string& data) {
+    return hashLeaf(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+}
+
+SM3MerkleTree::Digest SM3MerkleTree::hashNode(const Digest& left, const Digest& right) {
+    uint8_t block[1 + 2 * DIGEST_SIZE];
+    block[0] = 0x01;
+    std::memcpy(block + 1, left.data(), DIGEST_SIZE);
+    std::memcpy(block + 1 + DIGEST_SIZE, right.data(), DIGEST_SIZE);
+    Digest d;
+    SM3::Context ctx;
+    ctx.update(block, sizeof(block));
+    ctx.final(d.data());
+    return d;
+}
+
+void SM3MerkleTree::build(vector<Digest> leaves) {
+    levels.clear();
+    if (leaves.empty()) return;
+    levels.push_back(std::move(leaves));
+    extendUpper();
+}
+
+void SM3MerkleTree::build(const uint8_t* const* records, const size_t* lens, size_t n) {
+    vector<Digest> leaves(n);
+    auto record = [&](size_t i) { return std::make_pair(records[i], lens[i]); };
+    parallelRanges(n, LEAF_GROUP, [&](size_t begin, size_t end) {
+        hashLeaves(record, begin, end, leaves.data() + begin);
+    });
+    build(std::move(leaves));
+}
+
+void SM3MerkleTree::build(const vector<std::string>& records) {
+    vector<Digest> leaves(records.size());
+    auto record = [&](size_t i) {
+        return std::make_pair(reinterpret_cast<const uint8_t*>(records[i].data()), records[i].size());
+    };
+    parallelRanges(records.size(), LEAF_GROUP, [&](size_t begin, size_t end) {
+        hashLeaves(record, begin, end, leaves.data() + begin);
+    });
+    build(std::move(leaves));
+}
+
+void SM3MerkleTree::parallelRanges(size_t n, size_t minGroup,
+                                   const std::function<void(size_t, size_t)>& fn) const {
+    if (n <= minGroup) {
+        if (n) fn(0, n);
         return;
+    }
+    ThreadPool& tp = pool ? *pool : ThreadPool::global();
+    // 每个线程约 4 个任务，耗时不均时由线程池动态平衡
+    size_t group = std::max(minGroup, (n + tp.size() * 4 - 1) / (tp.size() * 4));
+    tp.parallelFor((n + group - 1) / group, [&](size_t t) {
+        fn(t * group, std::min(n, (t + 1) * group));
+    });
+}
+
+void SM3MerkleTree::extendUpper() {
+    for (size_t l = 0; levels[l].size() >= 2; ++l) {
+        if (l + 1 == levels.size()) levels.emplace_back();
+        size_t have = levels[l + 1].size(), want = levels[l].size() / 2;
+        // 这一层没有新的完整父节点，更上层也不会有
+        if (have == want) break;
+        levels[l + 1].resize(want);
+        const Digest* cur = levels[l].data() + 2 * have;
+        Digest* out = levels[l + 1].data() + have;
+        parallelRanges(want - have, NODE_GROUP, [&](size_t begin, size_t end) {
+            hashParents(cur + 2 * begin, end - begin, out + begin);
+        });
+    }
+}
+
+void SM3MerkleTree::append(const Digest& leaf) {
+    if (levels.empty()) levels.emplace_back();
+    levels[0].push_back(leaf);
+    extendUpper();
+}
+
+void SM3MerkleTree::append(const vector<Digest>& leaves) {
+    if (leaves.empty()) return;
+    if (levels.empty()) levels.emplace_back();
+    levels[0].insert(levels[0].end(), leaves.begin(), leaves.end());
+    extendUpper();
+}
+
+bool SM3MerkleTree::update(size_t index, const Digest& leaf) {
+    if (index >= size()) return false;
+    levels[0][index] = leaf;
+    for (size_t l = 1, i = index >> 1; l < levels.size() && i < levels[l].size(); ++l, i >>= 1) {
+        levels[l][i] = hashNode(levels[l - 1][2 * i], levels[l - 1][2 * i + 1]);
+    }
+    return true;
+}
+
+bool SM3MerkleTree::update(const vector<std::pair<uint64_t, Digest>>& changes) {
+    for (const auto& c : changes) {
+        if (c.first >= size()) return false;
+    }
+    // 同一下标出现多次时以最后一次为准
+    vector<uint64_t> dirty;
+    dirty.reserve(changes.size());
+    for (const auto& c : changes) {
+        levels[0][c.first] = c.second;
+        dirty.push_back(c.first >> 1);
+    }
+    std::sort(dirty.begin(), dirty.end());
+
+    // 逐层把待重算的父节点去重，共同祖先只算一次；孩子两两拷到一起后成批交给多缓冲内核
+    vector<Digest> kids, out;
+    for (size_t l = 1; l < levels.size(); ++l) {
+        dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+        dirty.erase(std::lower_bound(dirty.begin(), dirty.end(), uint64_t(levels[l].size())), dirty.end());
+        if (dirty.empty()) break;
+        size_t m = dirty.size();
+        kids.resize(2 * m);
+        out.resize(m);
+        for (size_t j = 0; j < m; ++j) {
+            kids[2 * j] = levels[l - 1][2 * dirty[j]];
+            kids[2 * j + 1] = levels[l - 1][2 * dirty[j] + 1];
+        }
+        parallelRanges(m, NODE_GROUP, [&](size_t begin, size_t end) {
+            hashParents(kids.data() + 2 * begin, end - begin, out.data() + begin);
+        });
+        for (size_t j = 0; j < m; ++j) {
+            levels[l][dirty[j]] = out[j];
+            dirty[j] >>= 1;
+        }
+    }
+    return true;
+}
+
+size_t SM3MerkleTree::height() const {
+    size_t h = 0;
+    for (uint64_t w = size(); w; w = w > 1 ? (w + 1) / 2 : 0) ++h;
+    return h;
+}
+
+SM3MerkleTree::Digest SM3MerkleTree::root() const {
+    return rootAt(size());
+}
+
+SM3MerkleTree::Digest SM3MerkleTree::subtree(uint64_t begin, uint64_t end) const {
+    size_t l = 0;
+    while ((uint64_t(1) << l) < end - begin) ++l;
+    // 完整子树：就是第 l 层存下的节点
+    if (end - begin == uint64_t(1) << l) return levels[l][begin >> l];
+    // 右边不完整：左孩子仍是完整子树，只需沿右边向下，即把右边缘上的完整子树依次合并
+    uint64_t half = uint64_t(1) << (l - 1);
+    return hashNode(levels[l - 1][begin >> (l - 1)], subtree(begin + half, end));
+}
+
+SM3MerkleTree::Digest SM3MerkleTree::nodeAt(size_t l, uint64_t i) const {
+    uint64_t begin = i << l;
+    return l < levels.size() && i < levels[l].size() ? levels[l][i] : subtree(begin, size());
+}
+
+SM3MerkleTree::Digest SM3MerkleTree::rootAt(size_t treeSize) const {
+    return treeSize ? subtree(0, treeSize) : emptyRoot();
+}
 
-    if (node->left && node->left->hash == targetHash) {
-        if (node->right) proof.push_back(node->right->hash);
-    } else if (node->right && node->right->hash == targetHash) {
-        if (node->left) proof.push_back(node->left->hash);
-    } else {
-        if (node->left && node->left->hash != targetHash) generateInclusionProof(node->left, targetHash, proof);
-        if (node->right && node->right->hash != targetHash) generateInclusionProof(node->right, targetHash, proof);
+bool SM3MerkleTree::prove(size_t index, InclusionProof& proof) const {
+    uint64_t n = size();
+    if (index >= n) return false;
+    proof.index = index;
+    proof.treeSize = n;
+    proof.path.clear();
+    // 第 l 层共 ceil(n / 2^l) 个节点，最后一个可能是右边缘的不完整子树
+    for (size_t l = 0; (n - 1) >> l; ++l) {
+        uint64_t i = index >> l, sib = i ^ 1;
+        if (sib <= (n - 1) >> l) proof.path.push_back({nodeAt(l, sib), (i & 1) != 0});
     }
+    return true;
 }
 
-// 主函数
-int main() {
-    const size_t N = 100000;
-    std::vector<MerkleNode*> leaves;
-    for (size_t i = 0; i < N; ++i) {
-        MerkleNode* leaf = new MerkleNode;
-        std::string data = "leaf_" + std::to_string(i);
-        leaf->hash = calcHash(data);
-        leaves.push_back(leaf);
+bool SM3MerkleTree::prove(size_t index, size_t treeSize, InclusionProof& proof) const {
+    if (treeSize > size() || index >= treeSize) return false;
+    if (treeSize == size()) return prove(index, proof);
+    proof.index = index;
+    proof.treeSize = treeSize;
+    proof.path.clear();
+    // RFC 6962 的 PATH(m, D[n]) 自顶向下展开：每次在小于区间长度的最大 2 的幂处切开
+    uint64_t begin = 0, end = treeSize;
+    while (end - begin > 1) {
+        uint64_t mid = begin + splitPoint(end - begin);
+        if (index < mid) {
+            proof.path.push_back({subtree(mid, end), false});
+            end = mid;
+        } else {
+            proof.path.push_back({subtree(begin, mid), true});
+            begin = mid;
+        }
     }
+    std::reverse(proof.path.begin(), proof.path.end());
+    return true;
+}
 
-    MerkleNode* root = buildMerkleTree(leaves);
-    std::cout << "Merkle Root: ";
-    for (auto c : root->hash) std::cout << std::hex << std::setw(2) << std::setfill('0') << (int)c;
-    std::cout << std::endl;
+bool SM3MerkleTree::proveMany(vector<uint64_t> indices, MultiProof& proof) const {
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+    if (indices.empty() || indices.back() >= size()) return false;
+    proof.treeSize = size();
+    proof.indices = indices;
+    proof.nodes.clear();
 
-    // 选择目标叶子
-    size_t targetIdx = 12345;
-    std::vector<uint8_t> targetHash = leaves[targetIdx]->hash;
-    std::vector<std::vector<uint8_t>> proof;
-    generateInclusionProof(root, targetHash, proof);
+    // 逐层维护已知节点的下标（升序）；兄弟也已知时不输出，两者合并为同一个父节点
+    vector<uint64_t>& known = indices;
+    uint64_t n = size();
+    for (size_t l = 0; (n - 1) >> l; ++l) {
+        size_t out = 0;
+        for (size_t j = 0; j < known.size(); ++j) {
+            uint64_t i = known[j], sib = i ^ 1;
+            if (sib <= (n - 1) >> l) {
+                if (j + 1 < known.size() && known[j + 1] == sib) {
+                    ++j;
+                } else {
+                    proof.nodes.push_back(nodeAt(l, sib));
+                }
+            }
+            known[out++] = i >> 1;
+        }
+        known.resize(out);
+    }
+    return true;
+}
 
-    std::cout << "Proof path for leaf_" << targetIdx << ":\n";
-    for (const auto& p : proof) {
-        for (auto c : p) std::cout << std::hex << std::setw(2) << std::setfill('0') << (int)c;
-        std::cout << "\n";
+bool SM3MerkleTree::verify(const Digest& leaf, const InclusionProof& proof, const Digest& root) {
+    if (proof.index >= proof.treeSize) return false;
+    Digest cur = leaf;
+    size_t k = 0;
+    for (uint64_t i = proof.index, w = proof.treeSize; w > 1; i >>= 1, w = (w + 1) / 2) {
+        if ((i ^ 1) >= w) continue;   // 原样上升
+        if (k == proof.path.size() || proof.path[k].left != ((i & 1) != 0)) return false;
+        const ProofStep& s = proof.path[k++];
+        cur = s.left ? hashNode(s.hash, cur) : hashNode(cur, s.hash);
     }
+    return k == proof.path.size() && cur == root;
+}
+
+bool SM3MerkleTree::verifyMany(const vector<Digest>& leaves, const MultiProof& proof, const Digest& root) {
+    size_t n = proof.indices.size();
+    if (n == 0 || leaves.size() != n || proof.indices.back() >= proof.treeSize) return false;
+    vector<std::pair<uint64_t, Digest>> known(n);
+    for (size_t j = 0; j < n; ++j) {
+        if (j && proof.indices[j] <= proof.indices[j - 1]) return false;
+        known[j] = {proof.indices[j], leaves[j]};
+    }
+
+    // 按 proveMany 的顺序重放：兄弟已知时取已知值，否则依次消耗 proof.nodes
+    size_t k = 0;
+    for (uint64_t w = proof.treeSize; w > 1; w = (w + 1) / 2) {
+        size_t out = 0;
+        for (size_t j = 0; j < known.size(); ++j) {
+            uint64_t i = known[j].first, sib = i ^ 1;
+            const Digest cur = known[j].second;
+            Digest parent = cur;
+            if (sib < w) {
+                Digest s;
+                if (j + 1 < known.size() && known[j + 1].first == sib) {
+                    s = known[++j].second;
+                } else if (k < proof.nodes.size()) {
+                    s = proof.nodes[k++];
+                } else {
+                    return false;
+                }
+                parent = (i & 1) ? hashNode(s, cur) : hashNode(cur, s);
+            }
+            known[out++] = {i >> 1, parent};
+        }
+        known.resize(out);
+    }
+    return k == proof.nodes.size() && known[0].second == root;
+}
+
+bool SM3MerkleTree::proveConsistency(size_t oldSize, size_t newSize, ConsistencyProof& proof) const {
+    if (oldSize > newSize || newSize > size()) return false;
+    proof.oldSize = oldSize;
+    proof.newSize = newSize;
+    proof.nodes.clear();
+    if (oldSize == 0 || oldSize == newSize) return true;
 
-    // Non-inclusion 证明可通过 hash 比较验证不存在（RFC6962 形式使用 audit path + neighbor hashes）
+    // RFC 6962 的 SUBPROOF(m, D[n], true) 自顶向下展开，tail 收集递归返回后追加的节点
+    vector<Digest> tail;
+    uint64_t begin = 0, end = newSize, m = oldSize;
+    bool whole = true;   // 当前区间仍是旧树本身，旧树根由验证者自己提供
+    while (m != end - begin) {
+        uint64_t k = splitPoint(end - begin);
+        if (m <= k) {
+            tail.push_back(subtree(begin + k, end));
+            end = begin + k;
+        } else {
+            tail.push_back(subtree(begin, begin + k));
+            begin += k;
+            m -= k;
+            whole = false;
+        }
+    }
+    if (!whole) proof.nodes.push_back(subtree(begin, end));
+    proof.nodes.insert(proof.nodes.end(), tail.rbegin(), tail.rend());
+    return true;
+}
+
+bool SM3MerkleTree::verifyConsistency(const ConsistencyProof& proof, const Digest& oldRoot,
+                                      const Digest& newRoot) {
+    uint64_t m = proof.oldSize, n = proof.newSize;
+    if (m > n) return false;
+    if (m == n) return proof.nodes.empty() && oldRoot == newRoot;
+    if (m == 0) return proof.nodes.empty() && oldRoot == emptyRoot();
+
+    // RFC 9162 2.1.4.2：同时重算旧根 fr 与新根 sr
+    vector<Digest> path;
+    if ((m & (m - 1)) == 0) path.push_back(oldRoot);   // 旧树是完整子树，证明中省略了它
+    path.insert(path.end(), proof.nodes.begin(), proof.nodes.end());
+    if (path.empty()) return false;
+
+    uint64_t fn = m - 1, sn = n - 1;
+    while (fn & 1) {
+        fn >>= 1;
+        sn >>= 1;
+    }
+    Digest fr = path[0], sr = path[0];
+    for (size_t i = 1; i < path.size(); ++i) {
+        if (sn == 0) return false;
+        if ((fn & 1) || fn == sn) {
+            fr = hashNode(path[i], fr);
+            sr = hashNode(path[i], sr);
+            while (!(fn & 1) && fn) {
+                fn >>= 1;
+                sn >>= 1;
+            }
+        } else {
+            sr = hashNode(sr, path[i]);
+        }
+        fn >>= 1;
+        sn >>= 1;
+    }
+    return sn == 0 && fr == oldRoot && sr == newRoot;
+}
+
+bool SM3MerkleTree::proveAbsent(const Digest& target, NonInclusionProof& proof) const {
+    size_t n = size();
+    size_t pos = n ? size_t(std::lower_bound(levels[0].begin(), levels[0].end(), target) - levels[0].begin()) : 0;
+    if (pos < n && levels[0][pos] == target) return false;
+    proof.treeSize = n;
+    proof.hasLeft = pos > 0;
+    proof.hasRight = pos < n;
+    if (proof.hasLeft) {
+        proof.left = levels[0][pos - 1];
+        prove(pos - 1, proof.leftProof);
+    }
+    if (proof.hasRight) {
+        proof.right = levels[0][pos];
+        prove(pos, proof.rightProof);
+    }
+    return true;
+}
+
+bool SM3MerkleTree::verifyAbsent(const Digest& target, const NonInclusionProof& proof, const Digest& root) {
+    uint64_t n = proof.treeSize;
+    if (n == 0) return !proof.hasLeft && !proof.hasRight && root == emptyRoot();
+    if (proof.hasLeft && !(proof.left < target && proof.leftProof.treeSize == n &&
+                           verify(proof.left, proof.leftProof, root))) {
+        return false;
+    }
+    if (proof.hasRight && !(target < proof.right && proof.rightProof.treeSize == n &&
+                            verify(proof.right, proof.rightProof, root))) {
+        return false;
+    }
+    // 相邻的两个叶子夹住目标，或目标在最左叶子之前、最右叶子之后
+    if (proof.hasLeft && proof.hasRight) return proof.leftProof.index + 1 == proof.rightProof.index;
+    if (proof.hasLeft) return proof.leftProof.index == n - 1;
+    if (proof.hasRight) return proof.rightProof.index == 0;
+    return false;
+}
+
+vector<uint8_t> SM3MerkleTree::serialize() const {
+    size_t nodes = 0;
+    for (const auto& lv : levels) nodes += lv.size();
+    vector<uint8_t> out(8 + nodes * DIGEST_SIZE);
+    uint64_t n = size();
+    for (int i = 0; i < 8; ++i) out[i] = uint8_t(n >> (56 - 8 * i));
+    uint8_t* p = out.data() + 8;
+    for (const auto& lv : levels) {
+        // Digest 是定长数组，整层是一段连续内存
+        std::memcpy(p, lv.data(), lv.size() * DIGEST_SIZE);
+        p += lv.size() * DIGEST_SIZE;
+    }
+    return out;
+}
+
+bool SM3MerkleTree::deserialize(const uint8_t* data, size_t len, std::string* error) {
+    auto fail = [&](const char* what) {
+        if (error) *error = what;
+        return false;
+    };
+    if (len < 8) return fail("truncated header");
+    uint64_t n = 0;
+    for (int i = 0; i < 8; ++i) n = (n << 8) | data[i];
+
+    // 先按叶子数推出各层宽度，核对总长度后再分配，避免损坏的头部导致巨大分配
+    vector<size_t> widths;
+    size_t nodes = 0;
+    for (uint64_t w = n; w; w >>= 1) {
+        if (w > (len - 8) / DIGEST_SIZE) return fail("size mismatch");
+        widths.push_back(size_t(w));
+        nodes += size_t(w);
+    }
+    if (nodes > (len - 8) / DIGEST_SIZE || 8 + nodes * DIGEST_SIZE != len) return fail("size mismatch");
+
+    vector<vector<Digest>> loaded(widths.size());
+    const uint8_t* p = data + 8;
+    for (size_t l = 0; l < widths.size(); ++l) {
+        loaded[l].resize(widths[l]);
+        std::memcpy(loaded[l].data(), p, widths[l] * DIGEST_SIZE);
+        p += widths[l] * DIGEST_SIZE;
+    }
+    levels.swap(loaded);
+    return true;
 }
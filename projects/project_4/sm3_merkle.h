@@ -0,0 +1,171 @@
+#ifndef SM3_MERKLE_H
+#define SM3_MERKLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+class ThreadPool;
+
+/*
+ * SM3MerkleTree
+ * 基于 SM3 的 Merkle 树，按层连续存储完整子树：levels[0] 是叶子摘要，levels[l][i] 的两个孩子是
+ * levels[l - 1][2i] 与 levels[l - 1][2i + 1]，第 l 层有 n >> l 个节点。
+ * 每个节点就是一个 32 字节的定长摘要，没有指针与逐节点的堆分配；内存占用约为 叶子数 × 64 字节，
+ * 建树、遍历、序列化都是顺序扫描。
+ * 叶子数不是 2 的幂时，右边缘还有不完整的子树（包括根），它们不存储，读取时由各层最右侧的完整子树
+ * （即“边界”，n 的每个二进制 1 位对应一个）合并得到，至多 O(log n) 次哈希。
+ *
+ * 哈希规则与 RFC 6962（证书透明日志）相同，只是把 SHA-256 换成 SM3：
+ *   叶子     L = SM3(0x00 || 数据)
+ *   内部节点 N = SM3(0x01 || 左 || 右)
+ *   某层节点数为奇数时，最后一个节点原样升到上一层（不与自身配对），
+ *   因此 levels[l][i] 恰好是叶子区间 [i·2^l, min((i+1)·2^l, n)) 的 RFC 6962 树根 MTH。
+ *   空树的根为 SM3("")
+ * 叶子与内部节点的输入域分开，内部节点不能冒充叶子（第二原像攻击）。
+ *
+ * 建树时叶子与每一层的父节点都分组交给线程池，组内用多缓冲内核（SM3_MB）一次压缩 8/16 个；
+ * 父节点的输入固定为 65 字节，直接在栈上拼成填充好的 2 个分组送入 compress8/compress16，
+ * 结果写回上一层的数组，不经过任何中间容器。
+ *
+ * 证明都按下标在各层数组中取节点，O(log n)，与叶子内容无关（重复的叶子互不影响）：
+ *   - 包含证明（RFC 6962 的审计路径），可针对当前或任一较早的树大小；
+ *   - 一组叶子的合并证明；
+ *   - 两个树大小之间的一致性证明（较早的树是当前树的前缀）；
+ *   - 叶子按摘要升序排列时，某个摘要不在树中的证明。
+ */
+class SM3MerkleTree {
+public:
+    static constexpr size_t DIGEST_SIZE = 32;
+    typedef std::array<uint8_t, DIGEST_SIZE> Digest;
+
+    // 证明中的一步：兄弟节点及其位置
+    struct ProofStep {
+        Digest hash;
+        bool left;      // 兄弟在左侧，即父节点 = SM3(0x01 || hash || 当前节点)
+    };
+
+    // 单个叶子的包含证明，path 自底向上；原样上升的层没有兄弟，不占一步
+    struct InclusionProof {
+        uint64_t index = 0;
+        uint64_t treeSize = 0;
+        std::vector<ProofStep> path;
+    };
+
+    /*
+     * 一组叶子的合并证明：路径上能由已知节点算出的兄弟不再重复给出
+     * nodes 按层自底向上、层内从左到右排列，位置由 indices 与 treeSize 推出
+     */
+    struct MultiProof {
+        uint64_t treeSize = 0;
+        std::vector<uint64_t> indices;   // 升序、无重复
+        std::vector<Digest> nodes;
+    };
+
+    // 大小为 oldSize 的树是大小为 newSize 的树的前缀（RFC 6962 2.1.2 的 PROOF(m, D[n])）
+    struct ConsistencyProof {
+        uint64_t oldSize = 0;
+        uint64_t newSize = 0;
+        std::vector<Digest> nodes;
+    };
+
+    /*
+     * 不在树中的证明，要求叶子摘要严格升序
+     * 给出与目标相邻的一个或两个叶子及其包含证明：两者下标相邻且 左 < 目标 < 右；
+     * 目标小于所有叶子时只有最左叶子，大于所有叶子时只有最右叶子
+     */
+    struct NonInclusionProof {
+        uint64_t treeSize = 0;
+        bool hasLeft = false;
+        bool hasRight = false;
+        Digest left{}, right{};
+        InclusionProof leftProof, rightProof;
+    };
+
+    // pool 为建树用的线程池，nullptr 表示全局线程池
+    explicit SM3MerkleTree(ThreadPool* pool = nullptr) : pool(pool) {}
+    // 由叶子摘要建树
+    explicit SM3MerkleTree(std::vector<Digest> leaves, ThreadPool* pool = nullptr);
+
+    static Digest hashLeaf(const uint8_t* data, size_t len);
+    static Digest hashLeaf(const std::string& data);
+    static Digest hashNode(const Digest& left, const Digest& right);
+
+    // 以新的叶子摘要重建整棵树
+    void build(std::vector<Digest> leaves);
+    /*
+     * 在末尾追加叶子：只计算新形成的完整父节点，单个叶子均摊 O(1) 次哈希；
+     * 批量追加时各层新增的父节点成批并行计算
+     */
+    void append(const Digest& leaf);
+    void append(const std::vector<Digest>& leaves);
+    /*
+     * 修改叶子，只重算受影响的 O(log n) 个完整祖先
+     * 批量修改时逐层去重，共同祖先只算一次；同一下标出现多次以最后一次为准
+     * 任一下标越界时返回 false 且不做任何修改
+     */
+    bool update(size_t index, const Digest& leaf);
+    bool update(const std::vector<std::pair<uint64_t, Digest>>& changes);
+    // 由原始记录重建整棵树，第 i 个叶子为 SM3(0x00 || records[i])
+    void build(const uint8_t* const* records, const size_t* lens, size_t n);
+    void build(const std::vector<std::string>& records);
+
+    size_t size() const { return levels.empty() ? 0 : levels[0].size(); }
+    // 层数（含叶子层与根），空树为 0
+    size_t height() const;
+    Digest root() const;
+    // 只含前 treeSize 个叶子的树的根，treeSize 不超过 size()
+    Digest rootAt(size_t treeSize) const;
+
+    // 第 l 层存下的完整子树
+    const std::vector<Digest>& level(size_t l) const { return levels[l]; }
+    const Digest& node(size_t l, size_t i) const { return levels[l][i]; }
+    const Digest& leaf(size_t i) const { return levels[0][i]; }
+
+    // 参数越界时返回 false
+    bool prove(size_t index, InclusionProof& proof) const;
+    // 针对只含前 treeSize 个叶子的树
+    bool prove(size_t index, size_t treeSize, InclusionProof& proof) const;
+    // 下标可以无序、重复，proof.indices 为整理后的结果；任一下标越界时返回 false
+    bool proveMany(std::vector<uint64_t> indices, MultiProof& proof) const;
+    // 要求 oldSize ≤ newSize ≤ size()
+    bool proveConsistency(size_t oldSize, size_t newSize, ConsistencyProof& proof) const;
+    // 要求叶子已按摘要升序；target 在树中时返回 false
+    bool proveAbsent(const Digest& target, NonInclusionProof& proof) const;
+
+    /*
+     * 验证证明，不需要整棵树；路径长度与各步位置必须与 index、treeSize 一致
+     * verifyMany 的 leaves 与 proof.indices 一一对应
+     */
+    static bool verify(const Digest& leaf, const InclusionProof& proof, const Digest& root);
+    static bool verifyMany(const std::vector<Digest>& leaves, const MultiProof& proof, const Digest& root);
+    static bool verifyConsistency(const ConsistencyProof& proof, const Digest& oldRoot, const Digest& newRoot);
+    static bool verifyAbsent(const Digest& target, const NonInclusionProof& proof, const Digest& root);
+
+    /*
+     * 序列化：8 字节大端叶子数，随后自底向上依次是各层存下的完整子树摘要（第 l 层 n >> l 个）
+     * 载入时不重新计算哈希，只校验长度；返回 false 时树保持不变，error 非空时写入原因
+     */
+    std::vector<uint8_t> serialize() const;
+    bool deserialize(const uint8_t* data, size_t len, std::string* error = nullptr);
+
+private:
+    // 叶子层增加后，逐层补算新形成的完整父节点
+    void extendUpper();
+    // 把 [0, n) 分组在线程池上执行 fn(begin, end)；工作量小时直接在调用线程上执行
+    void parallelRanges(size_t n, size_t minGroup, const std::function<void(size_t, size_t)>& fn) const;
+
+    // 叶子区间 [begin, end) 的 MTH；begin 须按区间长度向上取整的 2 的幂对齐，至多计算 O(log n) 次哈希
+    Digest subtree(uint64_t begin, uint64_t end) const;
+    // 第 l 层第 i 个节点，包括右边缘不完整的子树
+    Digest nodeAt(size_t l, uint64_t i) const;
+
+    std::vector<std::vector<Digest>> levels;
+    ThreadPool* pool;
+};
+
+#endif // SM3_MERKLE_H
@@ -0,0 +1,214 @@
+#include "sm3_mb.h"
+#include "sm3_merkle.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * SM3 Merkle 树演示
+ * 对 "leaf_0" ~ "leaf_{N-1}" 建树，输出根、建树耗时与占用；
+ * 输出 leaf_12345 的包含证明（L/R 表示兄弟在左/右），测量证明生成与验证的速率，并演示 64 个相邻叶子的合并证明、
+ * 前 90% 叶子与整棵树之间的一致性证明，以及叶子排序后 leaf_N 不存在的证明；
+ * 最后测量逐个追加叶子、逐个修改与批量修改叶子的耗时
+ * 用法: ./sm3_merkle [叶子数] [--threads N] [--scale]，默认 100000 个叶子、硬件并发数个线程
+ *   --scale 依次用 1, 2, 4, ... 个线程建树并输出耗时与加速比，首行是逐个节点串行计算的建树耗时作为对照
+ */
+
+// 解析非负十进制整数，拒绝负号、尾随字符与越界
+static bool parseNumber(const char* s, unsigned long& v) {
+    try {
+        size_t end = 0;
+        v = std::stoul(s, &end);
+        return s[end] == '\0' && s[0] != '-';
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+static int usage(const char* prog) {
+    std::cerr << "usage: " << prog << " [leaves] [--threads N] [--scale]\n";
+    return 2;
+}
+
+static void printHex(const SM3MerkleTree::Digest& d) {
+    for (auto c : d) std::cout << std::hex << std::setw(2) << std::setfill('0') << int(c);
+    std::cout << std::dec << std::setfill(' ');
+}
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 逐个叶子、逐个父节点串行计算的根，作为并行建树的对照
+static SM3MerkleTree::Digest serialRoot(const std::vector<std::string>& records) {
+    std::vector<SM3MerkleTree::Digest> level(records.size());
+    for (size_t i = 0; i < records.size(); ++i) level[i] = SM3MerkleTree::hashLeaf(records[i]);
+    while (level.size() > 1) {
+        size_t n = level.size();
+        for (size_t i = 0; i < n / 2; ++i) level[i] = SM3MerkleTree::hashNode(level[2 * i], level[2 * i + 1]);
+        if (n % 2) level[n / 2] = level[n - 1];
+        level.resize((n + 1) / 2);
+    }
+    return level.empty() ? SM3MerkleTree().root() : level[0];
+}
+
+static int scaling(const std::vector<std::string>& records, unsigned maxThreads) {
+    std::cout << "SM3 Merkle build scaling, " << records.size() << " leaves, " << SM3_MB::backendName() << "\n";
+    std::cout << std::fixed << std::setprecision(3);
+    auto start = std::chrono::steady_clock::now();
+    SM3MerkleTree::Digest expected = serialRoot(records);
+    double serial = seconds(start);
+    std::cout << std::setw(11) << "serial" << std::setw(10) << serial << " s\n";
+
+    for (unsigned t = 1;; t = std::min(t * 2, maxThreads)) {
+        ThreadPool pool(t);
+        SM3MerkleTree tree(&pool);
+        start = std::chrono::steady_clock::now();
+        tree.build(records);
+        double s = seconds(start);
+        if (tree.root() != expected) {
+            std::cerr << "root mismatch at " << t << " threads\n";
+            return 1;
+        }
+        std::cout << std::setw(7) << t << " thr" << std::setw(10) << s << " s" << std::setw(8)
+                  << std::setprecision(2) << serial / s << "x\n" << std::setprecision(3);
+        if (t == maxThreads) break;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    size_t n = 100000;
+    unsigned threads = 0;
+    bool scale = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--scale") {
+            scale = true;
+        } else if (i + 1 < argc && a == "--threads") {
+            unsigned long t;
+            if (!parseNumber(argv[++i], t) || t != unsigned(t)) return usage(argv[0]);
+            threads = unsigned(t);
+        } else if (a[0] != '-') {
+            unsigned long leaves;
+            if (!parseNumber(argv[i], leaves)) return usage(argv[0]);
+            n = size_t(leaves);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    std::vector<std::string> records(n);
+    for (size_t i = 0; i < n; ++i) records[i] = "leaf_" + std::to_string(i);
+    if (scale) return scaling(records, threads ? threads : std::max(1u, std::thread::hardware_concurrency()));
+
+    ThreadPool pool(threads);
+    SM3MerkleTree tree(&pool);
+    auto start = std::chrono::steady_clock::now();
+    tree.build(records);
+    double s = seconds(start);
+
+    std::cout << "Merkle Root: ";
+    printHex(tree.root());
+    std::cout << "\n" << n << " leaves, " << tree.height() << " levels, "
+              << tree.serialize().size() / 1024 << " KiB serialized, built in " << s << " s on "
+              << pool.size() << " threads (" << SM3_MB::backendName() << ")\n";
+
+    if (n == 0) return 0;
+
+    // 按下标生成包含证明并验证
+    size_t targetIdx = n > 12345 ? 12345 : n / 2;
+    SM3MerkleTree::InclusionProof proof;
+    tree.prove(targetIdx, proof);
+    std::cout << "Proof path for leaf_" << targetIdx << ":\n";
+    for (const auto& step : proof.path) {
+        std::cout << (step.left ? "L " : "R ");
+        printHex(step.hash);
+        std::cout << "\n";
+    }
+    const SM3MerkleTree::Digest root = tree.root();
+    bool ok = SM3MerkleTree::verify(tree.leaf(targetIdx), proof, root);
+    std::cout << "verify: " << (ok ? "OK" : "FAILED") << "\n";
+
+    // 证明生成与验证的速率
+    const size_t rounds = 100000;
+    start = std::chrono::steady_clock::now();
+    size_t steps = 0;
+    for (size_t r = 0; r < rounds; ++r) {
+        tree.prove((r * 7919) % n, proof);
+        steps += proof.path.size();
+    }
+    s = seconds(start);
+    std::cout << rounds / s / 1e3 << " K proofs/s (" << steps / rounds << " steps each), ";
+    tree.prove(targetIdx, proof);
+    start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds / 10; ++r) ok &= SM3MerkleTree::verify(tree.leaf(targetIdx), proof, root);
+    s = seconds(start);
+    std::cout << rounds / 10 / s / 1e3 << " K verifications/s\n";
+
+    // 一组相邻叶子的合并证明比各自证明之和小得多
+    std::vector<uint64_t> batch;
+    for (size_t i = 0; i < 64 && targetIdx + i < n; ++i) batch.push_back(targetIdx + i);
+    SM3MerkleTree::MultiProof multi;
+    tree.proveMany(batch, multi);
+    std::vector<SM3MerkleTree::Digest> batchLeaves;
+    size_t separate = 0;
+    for (uint64_t i : multi.indices) {
+        batchLeaves.push_back(tree.leaf(i));
+        tree.prove(i, proof);
+        separate += proof.path.size();
+    }
+    ok &= SM3MerkleTree::verifyMany(batchLeaves, multi, root);
+    std::cout << "multi-proof for " << multi.indices.size() << " leaves: " << multi.nodes.size()
+              << " nodes instead of " << separate << ", verify: "
+              << (ok ? "OK" : "FAILED") << "\n";
+
+    // 透明日志：较早的树（前 90% 的叶子）是当前树的前缀
+    size_t oldSize = n - n / 10;
+    SM3MerkleTree::ConsistencyProof consistency;
+    tree.proveConsistency(oldSize, n, consistency);
+    ok &= SM3MerkleTree::verifyConsistency(consistency, tree.rootAt(oldSize), tree.root());
+    std::cout << "consistency " << oldSize << " -> " << n << ": " << consistency.nodes.size()
+              << " nodes, verify: " << (ok ? "OK" : "FAILED") << "\n";
+
+    // 叶子按摘要排序后可以证明某条记录不存在
+    std::vector<SM3MerkleTree::Digest> sorted = tree.level(0);
+    std::sort(sorted.begin(), sorted.end());
+    SM3MerkleTree sortedTree(std::move(sorted));
+    SM3MerkleTree::Digest absent = SM3MerkleTree::hashLeaf("leaf_" + std::to_string(n));
+    SM3MerkleTree::NonInclusionProof nonInclusion;
+    ok &= sortedTree.proveAbsent(absent, nonInclusion);
+    ok &= SM3MerkleTree::verifyAbsent(absent, nonInclusion, sortedTree.root());
+    std::cout << "non-inclusion of leaf_" << n << " in sorted tree: "
+              << nonInclusion.leftProof.path.size() + nonInclusion.rightProof.path.size()
+              << " nodes, verify: " << (ok ? "OK" : "FAILED") << "\n";
+
+    // 增量维护：逐个追加、逐个修改与批量修改，均与重新建树的根比较
+    SM3MerkleTree incremental(&pool);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i) incremental.append(tree.leaf(i));
+    s = seconds(start);
+    ok &= incremental.root() == tree.root();
+    std::cout << "append one by one: " << s / n * 1e9 << " ns/leaf, root " << (ok ? "OK" : "FAILED") << "\n";
+
+    std::vector<std::pair<uint64_t, SM3MerkleTree::Digest>> changes(std::min<size_t>(n, 10000));
+    for (size_t i = 0; i < changes.size(); ++i) {
+        changes[i] = {(i * 7919) % n, SM3MerkleTree::hashLeaf("changed_" + std::to_string(i))};
+    }
+    start = std::chrono::steady_clock::now();
+    for (const auto& c : changes) incremental.update(c.first, c.second);
+    double single = seconds(start);
+    start = std::chrono::steady_clock::now();
+    tree.update(changes);
+    double batched = seconds(start);
+    ok &= incremental.root() == tree.root();
+    std::cout << changes.size() << " updates: " << single * 1e3 << " ms one by one, " << batched * 1e3
+              << " ms batched, root " << (ok ? "OK" : "FAILED") << "\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+#include "sm3_tree.h"
+#include "sm3.h"
+#include "sm3_mb.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using std::vector;
+
+namespace {
+
+/*
+ * 三个域的前缀分组压缩后的链接值，首次使用时计算
+ */
+struct Domains {
+    uint32_t leaf[8];
+    uint32_t node[8];
+    uint32_t root[8];
+
+    Domains() {
+        derive(0, leaf);
+        derive(1, node);
+        derive(2, root);
+    }
+
+    static void derive(uint8_t d, uint32_t H[8]) {
+        uint8_t block[64] = {};
+        std::memcpy(block, "SM3-TREE-v1", 11);
+        block[11] = d;
+        std::memcpy(H, SM3_IV, 32);
+        SM3::compressBlocks(H, block, 1);
+    }
+};
+
+const Domains& domains() {
+    static const Domains d;
+    return d;
+}
+
+// 每个任务至多处理的消息数；叶子较少时按线程数切小，让每个线程都有活
+size_t groupSize(size_t n, unsigned threads) {
+    size_t lanes = std::max<size_t>(SM3_MB::lanes(), 1);
+    size_t perThread = (n + threads - 1) / threads;
+    return std::max<size_t>(1, std::min(lanes, perThread));
+}
+
+void putBE64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) p[i] = uint8_t(v >> (56 - 8 * i));
+}
+
+} // namespace
+
+SM3Tree::SM3Tree(size_t chunkSize, ThreadPool* pool)
+    : chunkSize(chunkSize < 64 ? 64 : (chunkSize + 63) / 64 * 64),
+      pool(pool ? pool : &ThreadPool::global()) {}
+
+void SM3Tree::hashParallel(const uint32_t H0[8], const uint8_t* const* msgs, const size_t* lens,
+                           size_t n, uint8_t* out) const {
+    size_t group = groupSize(n, pool->size());
+    size_t tasks = (n + group - 1) / group;
+    pool->parallelFor(tasks, [&](size_t t) {
+        size_t begin = t * group;
+        size_t count = std::min(group, n - begin);
+        SM3_MB::hashMany(H0, 64, msgs + begin, lens + begin, count, out + begin * DIGEST_SIZE);
+    });
+}
+
+vector<uint8_t> SM3Tree::hash(const uint8_t* data, size_t len) const {
+    const Domains& dom = domains();
+
+    // 叶子层
+    size_t n = len ? (len + chunkSize - 1) / chunkSize : 1;
+    vector<const uint8_t*> ptrs(n);
+    vector<size_t> lens(n);
+    for (size_t i = 0; i < n; ++i) {
+        ptrs[i] = data + i * chunkSize;
+        lens[i] = std::min(chunkSize, len - std::min(len, i * chunkSize));
+    }
+    vector<uint8_t> level(n * DIGEST_SIZE), next;
+    hashParallel(dom.leaf, ptrs.data(), lens.data(), n, level.data());
+
+    // 逐层向上：相邻两个摘要在数组中本来就连续，直接作为 64 字节消息
+    while (n > 1) {
+        size_t pairs = n / 2;
+        next.resize((pairs + n % 2) * DIGEST_SIZE);
+        for (size_t i = 0; i < pairs; ++i) {
+            ptrs[i] = level.data() + i * 2 * DIGEST_SIZE;
+            lens[i] = 2 * DIGEST_SIZE;
+        }
+        hashParallel(dom.node, ptrs.data(), lens.data(), pairs, next.data());
+        if (n % 2) {
+            std::memcpy(next.data() + pairs * DIGEST_SIZE, level.data() + (n - 1) * DIGEST_SIZE, DIGEST_SIZE);
+        }
+        level.swap(next);
+        n = pairs + n % 2;
+    }
+
+    // 根：绑定总长度与块长
+    uint8_t tail[16];
+    putBE64(tail, len);
+    putBE64(tail + 8, chunkSize);
+    SM3::Context ctx(dom.root, 64);
+    ctx.update(level.data(), DIGEST_SIZE);
+    ctx.update(tail, sizeof(tail));
+    return ctx.final();
+}
+
+vector<uint8_t> SM3Tree::hash(const vector<uint8_t>& data) const {
+    return hash(data.data(), data.size());
+}
+
+bool SM3Tree::hashFile(const std::string& path, uint8_t digest[DIGEST_SIZE], std::string* error) const {
+    auto fail = [&](const std::string& what) {
+        if (error) *error = what + ": " + std::strerror(errno);
+        return false;
+    };
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return fail("open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        bool r = fail("fstat " + path);
+        ::close(fd);
+        return r;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        ::close(fd);
+        if (error) *error = path + ": not a regular file";
+        return false;
+    }
+
+    size_t size = size_t(st.st_size);
+    const uint8_t* data = nullptr;
+    void* map = MAP_FAILED;
+    if (size) {
+        map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            bool r = fail("mmap " + path);
+            ::close(fd);
+            return r;
+        }
+        // 各线程同时读文件的不同位置，访问并非顺序的，只提示内核尽早预读整个映射
+        ::madvise(map, size, MADV_WILLNEED);
+        data = static_cast<const uint8_t*>(map);
+    }
+    ::close(fd);
+
+    vector<uint8_t> d = hash(data, size);
+    std::memcpy(digest, d.data(), DIGEST_SIZE);
+    if (map != MAP_FAILED) ::munmap(map, size);
+    return true;
+}
@@ -0,0 +1,55 @@
+#ifndef SM3_TREE_H
+#define SM3_TREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+/*
+ * SM3Tree
+ * SM3 的树哈希模式：SM3 本身的 Merkle-Damgård 链严格串行，大文件只能用一个核。
+ * 树模式把输入按固定块长切成叶子，叶子之间互不依赖，在线程池上用多缓冲内核（SM3_MB）并行计算。
+ *
+ * 输出格式（版本 1，结果与线程数、CPU 指令集无关）：
+ *   前缀分组 P(d) = "SM3-TREE-v1" || 域字节 d || 52 字节 0，共 64 字节；d = 0 叶子、1 内部节点、2 根
+ *   叶子     L_i  = SM3(P(0) || 第 i 块)           块长 chunkSize，最后一块可以更短；空输入视为一个空块
+ *   内部节点 N    = SM3(P(1) || 左 || 右)           同一层相邻两个节点配对，落单的最后一个原样升到上一层
+ *   根       R    = SM3(P(2) || 顶层节点 || 总长度（8 字节大端） || chunkSize（8 字节大端）)
+ * 块长是结果的一部分：同一输入在不同块长下的摘要不同，默认 1 MiB。
+ * 树模式的摘要与普通 SM3 摘要不同，不能互换。
+ */
+class SM3Tree {
+public:
+    static constexpr size_t DIGEST_SIZE = 32;
+    static constexpr size_t DEFAULT_CHUNK = 1 << 20;
+
+    /*
+     * @param chunkSize: 叶子块长，不是 64 的倍数时向上取整
+     * @param pool: 计算叶子用的线程池，nullptr 表示全局线程池
+     */
+    explicit SM3Tree(size_t chunkSize = DEFAULT_CHUNK, ThreadPool* pool = nullptr);
+
+    std::vector<uint8_t> hash(const uint8_t* data, size_t len) const;
+    std::vector<uint8_t> hash(const std::vector<uint8_t>& data) const;
+
+    /*
+     * 对普通文件做树哈希：整个文件 mmap 后直接在映射上计算，不复制
+     * 返回 false 表示失败，error 非空时写入原因
+     */
+    bool hashFile(const std::string& path, uint8_t digest[DIGEST_SIZE], std::string* error = nullptr) const;
+
+    size_t chunk() const { return chunkSize; }
+
+private:
+    // 对 n 条消息（各自接在域前缀之后）并行求摘要
+    void hashParallel(const uint32_t H0[8], const uint8_t* const* msgs, const size_t* lens,
+                      size_t n, uint8_t* out) const;
+
+    size_t chunkSize;
+    ThreadPool* pool;
+};
+
+#endif // SM3_TREE_H
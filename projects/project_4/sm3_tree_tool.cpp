@@ -0,0 +1,158 @@
+#include "sm3.h"
+#include "sm3_mb.h"
+#include "sm3_tree.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+/*
+ * SM3 树哈希命令行工具（SM3Tree 的前端）
+ * 用法: ./sm3_tree <文件> [--chunk KiB] [--threads N] [--scale]
+ *   默认输出 "摘要  文件名"，并在 stderr 输出吞吐量；
+ *   --scale 依次用 1, 2, 4, ... 个线程（直到 --threads 或硬件并发数）计算并输出 GB/s 与加速比，
+ *           首行是普通 SM3 单线程的吞吐量作为对照。
+ */
+
+// 解析非负十进制整数，拒绝负号、尾随字符与越界
+static bool parseNumber(const char* s, unsigned long& v) {
+    try {
+        size_t end = 0;
+        v = std::stoul(s, &end);
+        return s[end] == '\0' && s[0] != '-';
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+static int usage(const char* prog) {
+    std::cerr << "usage: " << prog << " <file> [--chunk KiB] [--threads N] [--scale]\n";
+    return 2;
+}
+
+static std::string toHex(const uint8_t* d, size_t n) {
+    std::string s;
+    char buf[3];
+    for (size_t i = 0; i < n; ++i) {
+        std::snprintf(buf, sizeof(buf), "%02x", d[i]);
+        s += buf;
+    }
+    return s;
+}
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 普通 SM3 在同一映射上的单线程吞吐量
+static double serialGBps(const std::string& path, size_t size) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0 || size == 0) {
+        if (fd >= 0) ::close(fd);
+        return 0;
+    }
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return 0;
+    ::madvise(map, size, MADV_SEQUENTIAL);
+    auto start = std::chrono::steady_clock::now();
+    SM3::hash(static_cast<const uint8_t*>(map), size);
+    double s = seconds(start);
+    ::munmap(map, size);
+    return s > 0 ? double(size) / s / 1e9 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) return usage(argv[0]);
+    std::string path = argv[1];
+    size_t chunk = SM3Tree::DEFAULT_CHUNK;
+    unsigned threads = 0;
+    bool scale = false;
+    for (int i = 2; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--scale") {
+            scale = true;
+        } else if (i + 1 < argc && a == "--chunk") {
+            unsigned long kib;
+            if (!parseNumber(argv[++i], kib) || kib > SIZE_MAX / 1024) return usage(argv[0]);
+            chunk = size_t(kib) * 1024;
+        } else if (i + 1 < argc && a == "--threads") {
+            unsigned long n;
+            if (!parseNumber(argv[++i], n) || n != unsigned(n)) return usage(argv[0]);
+            threads = unsigned(n);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        std::cerr << path << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    size_t size = size_t(st.st_size);
+
+    if (!scale) {
+        ThreadPool pool(threads);
+        SM3Tree tree(chunk, &pool);
+        uint8_t digest[SM3Tree::DIGEST_SIZE];
+        std::string error;
+        auto start = std::chrono::steady_clock::now();
+        if (!tree.hashFile(path, digest, &error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        double s = seconds(start);
+        std::cout << toHex(digest, sizeof(digest)) << "  " << path << "\n";
+        if (s > 0) {
+            std::cerr << size << " bytes in " << s << " s (" << double(size) / s / 1e9 << " GB/s, "
+                      << pool.size() << " threads, " << SM3_MB::backendName() << ")\n";
+        }
+        return 0;
+    }
+
+    unsigned maxThreads = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "SM3 tree hash scaling, " << size << " bytes, chunk " << chunk / 1024 << " KiB, "
+              << SM3_MB::backendName() << "\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(11) << "serial" << std::setw(10) << serialGBps(path, size) << " GB/s\n";
+
+    double base = 0;
+    std::string first;
+    for (unsigned t = 1;; t = std::min(t * 2, maxThreads)) {
+        ThreadPool pool(t);
+        SM3Tree tree(chunk, &pool);
+        uint8_t digest[SM3Tree::DIGEST_SIZE];
+        std::string error;
+        tree.hashFile(path, digest, &error);   // 预热页缓存
+        auto start = std::chrono::steady_clock::now();
+        if (!tree.hashFile(path, digest, &error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        double gbps = double(size) / seconds(start) / 1e9;
+        if (t == 1) {
+            base = gbps;
+            first = toHex(digest, sizeof(digest));
+        } else if (toHex(digest, sizeof(digest)) != first) {
+            std::cerr << "digest mismatch at " << t << " threads\n";
+            return 1;
+        }
+        std::cout << std::setw(7) << t << " thr" << std::setw(10) << gbps << " GB/s"
+                  << std::setw(8) << std::setprecision(2) << gbps / base << "x\n" << std::setprecision(3);
+        if (t == maxThreads) break;
+    }
+    return 0;
+}
@@ -13,13 +13,6 @@ inline uint32_t SM3::rotl(uint32_t x, int n) {
     return (x << n) | (x >> (32 - n));
 }
 
-/*
- * 常量 Tj：0≤j≤15 时取 Tj15，否则取 Tj63
- */
-inline uint32_t SM3::T(int j) {
-    return (j < 16) ? 0x79cc4519u : 0x7a879d8au;
-}
-
 /*
  * 布尔函数 FF：
  * 0 ≤ j ≤ 15: x⊕y⊕z
@@ -54,29 +47,6 @@ inline uint32_t SM3::P1(uint32_t x) {
     return x ^ rotl(x, 15) ^ rotl(x, 23);
 }
 
-/*
- * 数据填充：先 append 0x80，再补 0，最后 append 64-bit 长度
- */
-void SM3::pad(const vector<uint8_t>& data, vector<uint8_t>& out) {
-    size_t len = data.size();
-    uint64_t bitLen = static_cast<uint64_t>(len) * 8;
-
-    // 原始数据复制
-    out.reserve(((len + 9 + 63) / 64) * 64);
-    out.insert(out.end(), data.begin(), data.end());
-
-    // 填充 0x80
-    out.push_back(0x80);
-    // 填充 0x00
-    size_t padZeros = (56 - (len + 1) % 64 + 64) % 64;
-    out.insert(out.end(), padZeros, 0x00);
-
-    // 长度 64-bit 大端序
-    for (int i = 7; i >= 0; --i) {
-        out.push_back(static_cast<uint8_t>(bitLen >> (i * 8)));
-    }
-}
-
 /*
  * 压缩函数：消息扩展 + 64 轮迭代
  */
@@ -106,7 +76,7 @@ void SM3::compress(uint32_t H[8], const uint8_t block[64]) {
 
     // 64 轮迭代
     for (int j = 0; j < 64; ++j) {
-        uint32_t SS1 = rotl(rotl(A, 12) + E + rotl(T(j), j), 7);
+        uint32_t SS1 = rotl(rotl(A, 12) + E + SM3_T_ROT[j], 7);
         uint32_t SS2 = SS1 ^ rotl(A, 12);
         uint32_t TT1 = FF(A, B, C, j) + D + SS2 + W1[j];
         uint32_t TT2 = GG(E, F, G, j) + Ht + SS1 + W[j];
@@ -126,41 +96,31 @@ void SM3::compress(uint32_t H[8], const uint8_t block[64]) {
     H[4] ^= E; H[5] ^= F; H[6] ^= G; H[7] ^= Ht;
 }
 
+void SM3::compressBlocks(uint32_t H[8], const uint8_t* data, size_t nblocks) {
+    for (size_t i = 0; i < nblocks; ++i) {
+        compress(H, data + i * 64);
+    }
+}
+
 /*
  * 对外接口：计算字节数组哈希
+ * 完整分组直接从输入压缩，只有最后一到两个分组在上下文内部填充
  */
-std::vector<uint8_t> SM3::hash(const std::vector<uint8_t>& data) {
-    // 1. 填充
-    std::vector<uint8_t> padded;
-    pad(data, padded);
-
-    // 2. 初始化向量
-    uint32_t H[8];
-    std::memcpy(H, IV, sizeof(H));
-
-    // 3. 分组压缩
-    size_t blocks = padded.size() / 64;
-    for (size_t i = 0; i < blocks; ++i) {
-        compress(H, padded.data() + i * 64);
-    }
+std::vector<uint8_t> SM3::hash(const uint8_t* data, size_t len) {
+    Context ctx;
+    ctx.update(data, len);
+    return ctx.final();
+}
 
-    // 4. 输出 32 字节摘要
-    std::vector<uint8_t> digest(32);
-    for (int i = 0; i < 8; ++i) {
-        digest[4*i    ] = static_cast<uint8_t>(H[i] >> 24);
-        digest[4*i + 1] = static_cast<uint8_t>(H[i] >> 16);
-        digest[4*i + 2] = static_cast<uint8_t>(H[i] >> 8);
-        digest[4*i + 3] = static_cast<uint8_t>(H[i]);
-    }
-    return digest;
+std::vector<uint8_t> SM3::hash(const std::vector<uint8_t>& data) {
+    return hash(data.data(), data.size());
 }
 
 /*
  * 对外接口：计算字符串哈希并返回大写十六进制
  */
 std::string SM3::hashHex(const std::string& input) {
-    std::vector<uint8_t> data(input.begin(), input.end());
-    auto digest = hash(data);
+    auto digest = hash(reinterpret_cast<const uint8_t*>(input.data()), input.size());
 
     std::ostringstream oss;
     oss << std::uppercase << std::hex << std::setfill('0');
@@ -1,22 +1,30 @@
 #ifndef SM3_H
 #define SM3_H
 
+#include "sm3_stream.h"
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 #include <string>
 
+class ThreadPool;
+
 /*
  * SM3 哈希算法类
  * 提供 SM3 摘要计算及十六进制字符串输出功能
+ * 流式计算使用 SM3::Context：ctx.update(data, len) 可多次调用，ctx.final(digest) 输出摘要
  */
 class SM3 {
 public:
+    typedef SM3Stream<SM3> Context;
+
     /*
      * 计算输入数据的 SM3 摘要
      * @param data: 待哈希的字节序列
      * @return 32 字节的哈希值
      */
     static std::vector<uint8_t> hash(const std::vector<uint8_t>& data);
+    static std::vector<uint8_t> hash(const uint8_t* data, size_t len);
 
     /*
      * 计算输入字符串的 SM3 摘要，并返回十六进制字符串
@@ -25,19 +33,36 @@ public:
      */
     static std::string hashHex(const std::string& input);
 
-private:
-    // 初始向量（IV），8×32 位
-    static constexpr uint32_t IV[8] = {
-        0x7380166f, 0x4914b2b9, 0x172442d7, 0xda8a0600,
-        0xa96f30bc, 0x163138aa, 0xe38dee4d, 0xb0fb0e4e
-    };
+    /*
+     * 计算文件的 SM3 摘要，不把文件读入内存
+     * 普通文件整体 mmap（MADV_SEQUENTIAL），映射直接喂给流式上下文，已处理的部分随即释放；
+     * 管道、终端等无法映射的输入用 1 MiB 缓冲区循环 read。path 为 "-" 时读标准输入。
+     * 返回 false 表示失败，error 非空时写入原因
+     */
+    static bool hashFile(const std::string& path, uint8_t digest[32], std::string* error = nullptr);
+    // 失败时返回空数组
+    static std::vector<uint8_t> hashFile(const std::string& path);
+
+    // 同上，输入为已打开的文件描述符；普通文件从头计算，其他类型从当前位置读到结尾
+    static bool hashFd(int fd, uint8_t digest[32], std::string* error = nullptr);
 
+    /*
+     * 在线程池 pool（nullptr 表示 ThreadPool::global()）上同时计算多个文件的摘要
+     * 结果与 paths 一一对应，失败的文件对应空数组，errors 非空时写入各自的原因
+     */
+    static std::vector<std::vector<uint8_t>> hashFiles(const std::vector<std::string>& paths,
+                                                       ThreadPool* pool = nullptr,
+                                                       std::vector<std::string>* errors = nullptr);
+
+    /*
+     * 从链接值 H 开始依次压缩 nblocks 个连续的 64 字节分组（不做填充）
+     */
+    static void compressBlocks(uint32_t H[8], const uint8_t* data, size_t nblocks);
+
+private:
     // 左循环移位操作
     static inline uint32_t rotl(uint32_t x, int n);
 
-    // 常量 Tj
-    static inline uint32_t T(int j);
-
     // 布尔函数 FF
     static inline uint32_t FF(uint32_t x, uint32_t y, uint32_t z, int j);
 
@@ -50,9 +75,6 @@ private:
     // 置换函数 P1
     static inline uint32_t P1(uint32_t x);
 
-    // 数据填充，补齐到 512 位的整数倍
-    static void pad(const std::vector<uint8_t>& data, std::vector<uint8_t>& out);
-
     // 压缩函数，对一个 512-bit 块进行迭代压缩
     static void compress(uint32_t H[8], const uint8_t block[64]);
 };
@@ -0,0 +1,112 @@
+#include "sm3.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * SM3 的文件接口（POSIX）
+ * 与 sm3.cpp 分开编译，只做内存哈希的程序不需要链接本文件和 thread_pool.cpp
+ */
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// read 回退路径的缓冲区大小
+const size_t READ_BUFFER = 1 << 20;
+// 映射按窗口喂给上下文，处理完的窗口立即 MADV_DONTNEED，常驻内存不随文件大小增长
+const size_t MAP_WINDOW = 64 << 20;
+
+bool fail(string* error, const string& what) {
+    if (error) *error = what + ": " + std::strerror(errno);
+    return false;
+}
+
+bool hashMapped(int fd, size_t size, SM3::Context& ctx) {
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) return false;
+    ::madvise(map, size, MADV_SEQUENTIAL);
+    const uint8_t* p = static_cast<const uint8_t*>(map);
+    for (size_t off = 0; off < size; off += MAP_WINDOW) {
+        size_t n = std::min(MAP_WINDOW, size - off);
+        ctx.update(p + off, n);
+        ::madvise(const_cast<uint8_t*>(p) + off, n, MADV_DONTNEED);
+    }
+    ::munmap(map, size);
+    return true;
+}
+
+bool hashStream(int fd, SM3::Context& ctx, string* error) {
+    vector<uint8_t> buf(READ_BUFFER);
+    for (;;) {
+        ssize_t n = ::read(fd, buf.data(), buf.size());
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return fail(error, "read");
+        }
+        if (n == 0) return true;
+        ctx.update(buf.data(), size_t(n));
+    }
+}
+
+} // namespace
+
+bool SM3::hashFd(int fd, uint8_t digest[32], string* error) {
+    Context ctx;
+    struct stat st;
+    bool regular = ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+    if (regular && st.st_size > 0 && hashMapped(fd, size_t(st.st_size), ctx)) {
+        ctx.final(digest);
+        return true;
+    }
+    if (regular) {
+        // 空文件或映射失败（如部分网络文件系统）：从头顺序读
+        if (::lseek(fd, 0, SEEK_SET) < 0) return fail(error, "lseek");
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+    if (!hashStream(fd, ctx, error)) return false;
+    ctx.final(digest);
+    return true;
+}
+
+bool SM3::hashFile(const string& path, uint8_t digest[32], string* error) {
+    if (path == "-") return hashFd(STDIN_FILENO, digest, error);
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return fail(error, "open " + path);
+    bool ok = hashFd(fd, digest, error);
+    if (!ok && error) *error = path + ": " + *error;
+    ::close(fd);
+    return ok;
+}
+
+vector<uint8_t> SM3::hashFile(const string& path) {
+    vector<uint8_t> digest(32);
+    if (!hashFile(path, digest.data())) digest.clear();
+    return digest;
+}
+
+vector<vector<uint8_t>> SM3::hashFiles(const vector<string>& paths, ThreadPool* pool,
+                                       vector<string>* errors) {
+    size_t n = paths.size();
+    vector<vector<uint8_t>> digests(n);
+    if (errors) errors->assign(n, string());
+    if (!pool) pool = &ThreadPool::global();
+
+    // 每个文件一个任务，线程池逐个领取，大小悬殊的文件也能均衡
+    pool->parallelFor(n, [&](size_t i) {
+        vector<uint8_t> d(32);
+        string err;
+        if (hashFile(paths[i], d.data(), &err)) {
+            digests[i].swap(d);
+        } else if (errors) {
+            (*errors)[i] = err;
+        }
+    });
+    return digests;
+}
@@ -0,0 +1,89 @@
+#ifndef SM3_ROUND_H
+#define SM3_ROUND_H
+
+#include "sm3_stream.h"
+#include <cstdint>
+
+#if defined(__GNUC__)
+#define SM3_FORCE_INLINE inline __attribute__((always_inline))
+#else
+#define SM3_FORCE_INLINE inline
+#endif
+
+/*
+ * SM3 轮函数引擎：轮号 J 是模板参数，64 轮在编译期展开
+ *   - FF/GG 的两个阶段用 if constexpr 选择，轮内没有 j < 16 的分支；
+ *   - 轮常量 Tj ≪ j 取自 SM3_T_ROT[J]，是编译期常量；
+ *   - 每轮原地更新 D、H、B、F，下一轮按 (D,A,B,C,H,E,F,G) 轮换角色，不搬移寄存器。
+ *
+ * 消息字的来源由 Sched 决定，只需提供
+ *     template <int J> void load(uint32_t& w, uint32_t& w1);   // w = W[J]，w1 = W[J] ⊕ W[J+4]
+ * 预先算好整张 W/W1 表的实现用 SM3RoundEngine::ArraySchedule，
+ * 即时计算的实现（SM3_OTF）在 load 中按需扩展环形缓冲区。
+ */
+class SM3RoundEngine {
+public:
+    // 消息字取自预先扩展好的 W[68] 与 W1[64]
+    struct ArraySchedule {
+        const uint32_t* W;
+        const uint32_t* W1;
+
+        template <int J>
+        SM3_FORCE_INLINE void load(uint32_t& w, uint32_t& w1) const {
+            w = W[J];
+            w1 = W1[J];
+        }
+    };
+
+    // 64 轮迭代并把结果异或进链接值 H
+    template <typename Sched>
+    static SM3_FORCE_INLINE void compress(uint32_t H[8], Sched& sched) {
+        uint32_t A = H[0], B = H[1], C = H[2], D = H[3];
+        uint32_t E = H[4], F = H[5], G = H[6], Ht = H[7];
+        rounds<0>(A, B, C, D, E, F, G, Ht, sched);
+        // 64 是 4 的倍数，寄存器角色已经复原
+        H[0] ^= A; H[1] ^= B; H[2] ^= C; H[3] ^= D;
+        H[4] ^= E; H[5] ^= F; H[6] ^= G; H[7] ^= Ht;
+    }
+
+private:
+    static constexpr uint32_t rotl(uint32_t x, int n) {
+        return (x << n) | (x >> (32 - n));
+    }
+
+    template <int J>
+    static SM3_FORCE_INLINE uint32_t FF(uint32_t x, uint32_t y, uint32_t z) {
+        if constexpr (J < 16) return x ^ y ^ z;
+        else return (x & y) | (x & z) | (y & z);
+    }
+
+    template <int J>
+    static SM3_FORCE_INLINE uint32_t GG(uint32_t x, uint32_t y, uint32_t z) {
+        if constexpr (J < 16) return x ^ y ^ z;
+        else return (x & y) | (~x & z);
+    }
+
+    static SM3_FORCE_INLINE uint32_t P0(uint32_t x) {
+        return x ^ rotl(x, 9) ^ rotl(x, 17);
+    }
+
+    template <int J, typename Sched>
+    static SM3_FORCE_INLINE void rounds(uint32_t& A, uint32_t& B, uint32_t& C, uint32_t& D,
+                                        uint32_t& E, uint32_t& F, uint32_t& G, uint32_t& H,
+                                        Sched& sched) {
+        if constexpr (J < 64) {
+            uint32_t w, w1;
+            sched.template load<J>(w, w1);
+            uint32_t a12 = rotl(A, 12);
+            uint32_t SS1 = rotl(a12 + E + SM3_T_ROT[J], 7);
+            uint32_t SS2 = SS1 ^ a12;
+            D = FF<J>(A, B, C) + D + SS2 + w1;   // TT1，成为下一轮的 A
+            H = P0(GG<J>(E, F, G) + H + SS1 + w); // P0(TT2)，成为下一轮的 E
+            B = rotl(B, 9);
+            F = rotl(F, 19);
+            rounds<J + 1>(D, A, B, C, H, E, F, G, sched);
+        }
+    }
+};
+
+#endif // SM3_ROUND_H
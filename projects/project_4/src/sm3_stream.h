@@ -0,0 +1,139 @@
+#ifndef SM3_STREAM_H
+#define SM3_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// SM3 初始向量（IV），8×32 位
+constexpr uint32_t SM3_IV[8] = {
+    0x7380166f, 0x4914b2b9, 0x172442d7, 0xda8a0600,
+    0xa96f30bc, 0x163138aa, 0xe38dee4d, 0xb0fb0e4e
+};
+
+// 轮常量 Tj ≪ (j mod 32)，0 ≤ j ≤ 63，各实现直接查表，不在轮函数里做移位
+constexpr uint32_t SM3_T_ROT[64] = {
+    0x79cc4519, 0xf3988a32, 0xe7311465, 0xce6228cb,
+    0x9cc45197, 0x3988a32f, 0x7311465e, 0xe6228cbc,
+    0xcc451979, 0x988a32f3, 0x311465e7, 0x6228cbce,
+    0xc451979c, 0x88a32f39, 0x11465e73, 0x228cbce6,
+    0x9d8a7a87, 0x3b14f50f, 0x7629ea1e, 0xec53d43c,
+    0xd8a7a879, 0xb14f50f3, 0x629ea1e7, 0xc53d43ce,
+    0x8a7a879d, 0x14f50f3b, 0x29ea1e76, 0x53d43cec,
+    0xa7a879d8, 0x4f50f3b1, 0x9ea1e762, 0x3d43cec5,
+    0x7a879d8a, 0xf50f3b14, 0xea1e7629, 0xd43cec53,
+    0xa879d8a7, 0x50f3b14f, 0xa1e7629e, 0x43cec53d,
+    0x879d8a7a, 0x0f3b14f5, 0x1e7629ea, 0x3cec53d4,
+    0x79d8a7a8, 0xf3b14f50, 0xe7629ea1, 0xcec53d43,
+    0x9d8a7a87, 0x3b14f50f, 0x7629ea1e, 0xec53d43c,
+    0xd8a7a879, 0xb14f50f3, 0x629ea1e7, 0xc53d43ce,
+    0x8a7a879d, 0x14f50f3b, 0x29ea1e76, 0x53d43cec,
+    0xa7a879d8, 0x4f50f3b1, 0x9ea1e762, 0x3d43cec5
+};
+
+/*
+ * SM3 流式上下文（init / update / final）
+ * Impl 提供压缩函数 Impl::compressBlocks(H, data, nblocks)，四种实现共用同一套缓冲与填充逻辑：
+ *   - update 直接在调用者的缓冲区上压缩完整的 64 字节分组，只缓存不足一组的尾部；
+ *   - final 只在最后一到两个分组上做填充，不复制整条消息。
+ * final 之后上下文自动 reset 回起始状态，可以继续计算下一条消息。
+ */
+template <typename Impl>
+class SM3Stream {
+public:
+    static constexpr size_t BLOCK_SIZE = 64;
+    static constexpr size_t DIGEST_SIZE = 32;
+
+    SM3Stream() : startTotal(0) {
+        std::memcpy(startH, SM3_IV, sizeof(startH));
+        reset();
+    }
+
+    /*
+     * 从已压缩 processed 字节之后的链接值 H 继续（processed 须为 64 的倍数）
+     * 用于 HMAC 的预计算状态等场景；reset 与 final 之后回到这个状态，而不是 SM3_IV
+     */
+    SM3Stream(const uint32_t H[8], uint64_t processed) : startTotal(processed) {
+        std::memcpy(startH, H, sizeof(startH));
+        reset();
+    }
+
+    // 回到构造时的起始状态
+    void reset() {
+        std::memcpy(H, startH, sizeof(H));
+        bufLen = 0;
+        total = startTotal;
+    }
+
+    void update(const uint8_t* data, size_t len) {
+        total += len;
+        if (bufLen) {
+            size_t n = BLOCK_SIZE - bufLen;
+            if (len < n) {
+                std::memcpy(buf + bufLen, data, len);
+                bufLen += len;
+                return;
+            }
+            std::memcpy(buf + bufLen, data, n);
+            Impl::compressBlocks(H, buf, 1);
+            data += n;
+            len -= n;
+            bufLen = 0;
+        }
+        size_t blocks = len / BLOCK_SIZE;
+        if (blocks) {
+            Impl::compressBlocks(H, data, blocks);
+            data += blocks * BLOCK_SIZE;
+            len -= blocks * BLOCK_SIZE;
+        }
+        if (len) {
+            std::memcpy(buf, data, len);
+            bufLen = len;
+        }
+    }
+
+    void update(const std::vector<uint8_t>& data) { update(data.data(), data.size()); }
+
+    void final(uint8_t digest[DIGEST_SIZE]) {
+        uint64_t bitLen = total * 8;
+        buf[bufLen++] = 0x80;
+        if (bufLen > 56) {
+            std::memset(buf + bufLen, 0, BLOCK_SIZE - bufLen);
+            Impl::compressBlocks(H, buf, 1);
+            bufLen = 0;
+        }
+        std::memset(buf + bufLen, 0, 56 - bufLen);
+        for (int i = 0; i < 8; ++i) {
+            buf[56 + i] = uint8_t(bitLen >> (56 - 8 * i));
+        }
+        Impl::compressBlocks(H, buf, 1);
+        for (int i = 0; i < 8; ++i) {
+            digest[4*i    ] = uint8_t(H[i] >> 24);
+            digest[4*i + 1] = uint8_t(H[i] >> 16);
+            digest[4*i + 2] = uint8_t(H[i] >> 8);
+            digest[4*i + 3] = uint8_t(H[i]);
+        }
+        reset();
+    }
+
+    std::vector<uint8_t> final() {
+        std::vector<uint8_t> digest(DIGEST_SIZE);
+        final(digest.data());
+        return digest;
+    }
+
+    // 已输入的总字节数
+    uint64_t length() const { return total; }
+
+private:
+    uint32_t H[8];
+    uint8_t buf[BLOCK_SIZE];
+    size_t bufLen;
+    uint64_t total;
+    // 起始链接值与已压缩字节数，默认构造时为 SM3_IV 与 0
+    uint32_t startH[8];
+    uint64_t startTotal;
+};
+
+#endif // SM3_STREAM_H
@@ -1,6 +1,52 @@
 #include "sm3.h"
+#include "sm3_hmac.h"
+#include "sm3_mb.h"
+#include "sm3_merkle.h"
+#include "sm3_otf.h"
+#include "sm3_simd.h"
+#include "sm3_tree.h"
+#include "thread_pool.h"
+#include "unroll_sm3.h"
+#include <algorithm>
 #include <iostream>
 #include <cassert>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+/*
+ * 检查实现 Impl 的一次性接口与按 step 分段的流式接口都与参考结果 ref 一致
+ */
+template <typename Impl>
+static bool sameAsReference(const uint8_t* data, size_t len, const std::vector<uint8_t>& ref, size_t step) {
+    if (Impl::hash(data, len) != ref) return false;
+    typename Impl::Context ctx;
+    for (size_t pos = 0; pos < len; pos += step) {
+        ctx.update(data + pos, std::min(step, len - pos));
+    }
+    return ctx.final() == ref;
+}
+
+/*
+ * 按 RFC 6962 2.1 的递归定义计算 MTH(D[begin:end])，直接用 SM3 拼接前缀，作为 SM3MerkleTree 的对照
+ * leaves 为叶子数据的 SM3(0x00 || 数据)
+ */
+static std::vector<uint8_t> referenceMTH(const std::vector<std::vector<uint8_t>>& leaves, size_t begin, size_t end) {
+    if (begin == end) return SM3::hash(nullptr, 0);
+    if (end - begin == 1) return leaves[begin];
+    size_t k = 1;
+    while (k * 2 < end - begin) k *= 2;
+    std::vector<uint8_t> left = referenceMTH(leaves, begin, begin + k);
+    std::vector<uint8_t> right = referenceMTH(leaves, begin + k, end);
+    std::vector<uint8_t> msg(1, 0x01);
+    msg.insert(msg.end(), left.begin(), left.end());
+    msg.insert(msg.end(), right.begin(), right.end());
+    return SM3::hash(msg);
+}
 
 /*
  * SM3 算法单元测试
@@ -20,9 +66,461 @@ int main() {
     std::string input2  = "test sm3 hash";
     std::string output2 = SM3::hashHex(input2);
 
+    std::string expected2 = "56EFB662BB38F25CEF78A4F089612B7CA01364F9A081D9F8A35366E6AADEECDF";
+
     std::cout << "Test 2 - Input: " << input2 << "\n"
+              << "Expected: " << expected2 << "\n"
               << "Output:   " << output2 << "\n\n";
-    // 仅展示结果，无断言
+    assert(output2 == expected2);
+
+    // 测试 3: 流式接口，GB/T 32905 附录 A.2 的 64 字节消息，按不同步长分段输入
+    std::string input3 = "abcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcd";
+    std::string expected3 = "DEBE9FF92275B8A138604889C18E5A4D6FDB70E5387E5765293DCBA39C0C5732";
+    std::vector<uint8_t> msg3(input3.begin(), input3.end());
+    for (size_t step : {1, 3, 55, 56, 63, 64, 65}) {
+        SM3::Context ctx;
+        for (size_t pos = 0; pos < msg3.size(); pos += step) {
+            ctx.update(msg3.data() + pos, std::min(step, msg3.size() - pos));
+        }
+        assert(ctx.final() == SM3::hash(msg3));
+    }
+    assert(SM3::hashHex(input3) == expected3);
+
+    // 同一上下文 final 后自动复位，长消息分段与一次性结果一致
+    std::vector<uint8_t> big(10000);
+    for (size_t i = 0; i < big.size(); ++i) big[i] = uint8_t(i * 31 + 7);
+    SM3::Context ctx;
+    for (size_t len : {0, 1, 55, 56, 64, 119, 120, 128, 10000}) {
+        ctx.update(big.data(), len / 2);
+        ctx.update(big.data() + len / 2, len - len / 2);
+        assert(ctx.final() == SM3::hash(big.data(), len));
+    }
+    // 从链接值继续的上下文，final 后回到该链接值而不是 SM3_IV
+    uint32_t H1[8];
+    std::memcpy(H1, SM3_IV, sizeof(H1));
+    SM3::compressBlocks(H1, big.data(), 1);
+    SM3::Context resumed(H1, 64);
+    for (size_t len : {64, 100, 10000}) {
+        resumed.update(big.data() + 64, len - 64);
+        assert(resumed.final() == SM3::hash(big.data(), len));
+    }
+    std::cout << "Test 3 - SM3::Context streaming OK\n\n";
+
+    // 测试 4: 多缓冲批量哈希，长度参差不齐（含 55/56/64 边界）的消息逐条与标量结果比对
+    std::vector<std::vector<uint8_t>> msgs;
+    const size_t edges[] = {0, 55, 56, 63, 64, 65};
+    for (size_t i = 0; i < 100; ++i) {
+        size_t len = (i * 37) % 300;
+        if (i % 10 == 0) len = (i / 10) * 1000;   // 混入长消息，各通道结束时刻不同
+        if (i < 6) len = edges[i];
+        msgs.emplace_back(big.begin(), big.begin() + len);
+    }
+    for (size_t n : {1, 3, 17, 100}) {
+        std::vector<std::vector<uint8_t>> batch(msgs.begin(), msgs.begin() + n);
+        std::vector<std::vector<uint8_t>> digests = SM3_MB::hashMany(batch);
+        for (size_t i = 0; i < n; ++i) assert(digests[i] == SM3::hash(batch[i]));
+    }
+    std::cout << "Test 4 - SM3_MB::hashMany (" << SM3_MB::backendName() << ") OK\n\n";
+
+    // 测试 5: 向量化消息扩展的单流实现与标量结果一致
+    for (size_t len = 0; len <= 300; ++len) {
+        assert(SM3_SIMD::hash(big.data(), len) == SM3::hash(big.data(), len));
+    }
+    assert(SM3_SIMD::hash(big) == SM3::hash(big));
+    assert(SM3_SIMD::hashHex(input1) == expected1);
+    std::cout << "Test 5 - SM3_SIMD OK\n\n";
+
+    // 测试 6: 树哈希，按文档格式用普通 SM3 逐层重算，并检查结果与线程数无关
+    {
+        const size_t chunk = 128;
+        auto prefixed = [](uint8_t d, const uint8_t* p, size_t n) {
+            std::vector<uint8_t> m(64, 0);
+            std::memcpy(m.data(), "SM3-TREE-v1", 11);
+            m[11] = d;
+            m.insert(m.end(), p, p + n);
+            return SM3::hash(m);
+        };
+        ThreadPool pool1(1), pool3(3);
+        SM3Tree tree1(chunk, &pool1), tree3(chunk, &pool3);
+        for (size_t len : {0, 1, 128, 129, 640, 1000, 10000}) {
+            std::vector<std::vector<uint8_t>> level;
+            for (size_t off = 0; off < len || level.empty(); off += chunk) {
+                level.push_back(prefixed(0, big.data() + off, std::min(chunk, len - off)));
+            }
+            while (level.size() > 1) {
+                std::vector<std::vector<uint8_t>> up;
+                for (size_t i = 0; i + 1 < level.size(); i += 2) {
+                    std::vector<uint8_t> pair(level[i]);
+                    pair.insert(pair.end(), level[i + 1].begin(), level[i + 1].end());
+                    up.push_back(prefixed(1, pair.data(), pair.size()));
+                }
+                if (level.size() % 2) up.push_back(level.back());
+                level.swap(up);
+            }
+            std::vector<uint8_t> rootMsg(level[0]);
+            for (uint64_t v : {uint64_t(len), uint64_t(chunk)}) {
+                for (int i = 0; i < 8; ++i) rootMsg.push_back(uint8_t(v >> (56 - 8 * i)));
+            }
+            std::vector<uint8_t> expected = prefixed(2, rootMsg.data(), rootMsg.size());
+            assert(tree1.hash(big.data(), len) == expected);
+            assert(tree3.hash(big.data(), len) == expected);
+        }
+    }
+    std::cout << "Test 6 - SM3Tree OK\n\n";
+
+    // 测试 7: 文件接口——mmap 路径、管道上的 read 路径、多文件并发与错误报告
+    {
+        char path[] = "/tmp/sm3_test_XXXXXX";
+        int fd = mkstemp(path);
+        assert(fd >= 0);
+        ssize_t written = write(fd, big.data(), big.size());
+        assert(written == ssize_t(big.size()));
+        close(fd);
+        assert(SM3::hashFile(path) == SM3::hash(big));
+
+        int fds[2];
+        int rc = pipe(fds);
+        assert(rc == 0);
+        std::thread writer([&] {
+            for (size_t off = 0; off < big.size(); off += 4096) {
+                ssize_t w = write(fds[1], big.data() + off, std::min<size_t>(4096, big.size() - off));
+                assert(w > 0);
+            }
+            close(fds[1]);
+        });
+        uint8_t digest[32];
+        bool ok = SM3::hashFd(fds[0], digest);
+        assert(ok);
+        writer.join();
+        close(fds[0]);
+        assert(std::vector<uint8_t>(digest, digest + 32) == SM3::hash(big));
+
+        std::string error;
+        ok = SM3::hashFile("/nonexistent/sm3", digest, &error);
+        assert(!ok && !error.empty());
+        std::vector<std::string> errors;
+        ThreadPool pool(2);
+        auto many = SM3::hashFiles({path, "/nonexistent/sm3", path}, &pool, &errors);
+        assert(many[0] == SM3::hash(big) && many[2] == many[0]);
+        assert(many[1].empty() && !errors[1].empty() && errors[0].empty());
+        unlink(path);
+    }
+    std::cout << "Test 7 - SM3::hashFile OK\n\n";
+
+    // 测试 8: HMAC-SM3，RFC 4231 形式的两组输入（结果与 OpenSSL 一致），以及批量接口
+    {
+        std::vector<uint8_t> key1(20, 0x0b), key2(131, 0xaa);
+        std::string m1 = "Hi There";
+        std::string m2 = "Test Using Larger Than Block-Size Key - Hash Key First";
+        SM3_HMAC h1(key1), h2(key2);
+        auto hex = [](const std::vector<uint8_t>& d) {
+            static const char* digits = "0123456789ABCDEF";
+            std::string s;
+            for (uint8_t b : d) { s += digits[b >> 4]; s += digits[b & 15]; }
+            return s;
+        };
+        std::vector<uint8_t> t1 = h1.mac(reinterpret_cast<const uint8_t*>(m1.data()), m1.size());
+        std::vector<uint8_t> t2 = h2.mac(reinterpret_cast<const uint8_t*>(m2.data()), m2.size());
+        assert(hex(t1) == "51B00D1FB49832BFB01C3CE27848E59F871D9BA938DC563B338CA964755CCE70");
+        assert(hex(t2) == "B4FD844E13342002F0B2E0690EA7741F1497D993A70494CEA601E657BEDF67A0");
+        assert(h1.verify(reinterpret_cast<const uint8_t*>(m1.data()), m1.size(), t1.data()));
+        t1[31] ^= 1;
+        assert(!h1.verify(reinterpret_cast<const uint8_t*>(m1.data()), m1.size(), t1.data()));
+
+        std::vector<std::vector<uint8_t>> tags = h2.macMany(msgs);
+        for (size_t i = 0; i < msgs.size(); ++i) assert(tags[i] == h2.mac(msgs[i]));
+    }
+    std::cout << "Test 8 - SM3_HMAC OK\n\n";
+
+    // 测试 9: 各实现交叉验证——标准向量，0~200 全部长度、55/56/64 附近的边界与 0~10 KB 随机长度
+    {
+        const std::pair<std::string, std::string> vectors[] = {{input1, expected1}, {input3, expected3}};
+        for (const auto& v : vectors) {
+            assert(SM3_SIMD::hashHex(v.first) == v.second);
+            assert(SM3_OTF::hashHex(v.first) == v.second);
+            assert(SM3_UNROLLED::hashHex(v.first) == v.second);
+        }
+
+        std::mt19937 rng(20240601);
+        std::vector<uint8_t> data(10 * 1024 + 1);
+        for (auto& b : data) b = uint8_t(rng());
+        std::vector<size_t> lens;
+        for (size_t len = 0; len <= 200; ++len) lens.push_back(len);
+        for (size_t base : {64, 128, 1024, 4096}) {
+            for (size_t d : {55, 56, 57, 63, 64, 65}) lens.push_back(base + d);
+        }
+        for (int i = 0; i < 300; ++i) lens.push_back(rng() % data.size());
+        lens.push_back(data.size());
+
+        std::vector<const uint8_t*> ptrs(lens.size());
+        std::vector<uint8_t> batch(lens.size() * 32);
+        for (size_t i = 0; i < lens.size(); ++i) {
+            size_t offset = rng() % 7;   // 不对齐的起点
+            ptrs[i] = data.data() + offset;
+            lens[i] = std::min(lens[i], data.size() - offset);
+        }
+        SM3_MB::hashMany(ptrs.data(), lens.data(), lens.size(), batch.data());
+
+        for (size_t i = 0; i < lens.size(); ++i) {
+            const uint8_t* p = ptrs[i];
+            size_t len = lens[i];
+            std::vector<uint8_t> ref = SM3::hash(p, len);
+            size_t step = 1 + rng() % 100;
+            if (!sameAsReference<SM3>(p, len, ref, step) ||
+                !sameAsReference<SM3_SIMD>(p, len, ref, step) ||
+                !sameAsReference<SM3_OTF>(p, len, ref, step) ||
+                !sameAsReference<SM3_UNROLLED>(p, len, ref, step) ||
+                std::vector<uint8_t>(batch.begin() + i * 32, batch.begin() + (i + 1) * 32) != ref) {
+                std::cout << "Mismatch at length " << len << "\n";
+                assert(false);
+            }
+        }
+        std::cout << "Test 9 - cross-check of " << lens.size() << " lengths over all variants OK\n\n";
+    }
+
+    // 测试 10: Merkle 树按层存储，与 RFC 6962 的递归定义对照；序列化往返
+    {
+        for (size_t n = 0; n <= 33; ++n) {
+            std::vector<SM3MerkleTree::Digest> leaves(n);
+            std::vector<std::vector<uint8_t>> ref(n);
+            for (size_t i = 0; i < n; ++i) {
+                std::string data = "leaf_" + std::to_string(i);
+                leaves[i] = SM3MerkleTree::hashLeaf(data);
+                std::vector<uint8_t> msg(1, 0x00);
+                msg.insert(msg.end(), data.begin(), data.end());
+                ref[i] = SM3::hash(msg);
+                assert(std::vector<uint8_t>(leaves[i].begin(), leaves[i].end()) == ref[i]);
+            }
+
+            SM3MerkleTree tree(leaves);
+            SM3MerkleTree::Digest root = tree.root();
+            assert(std::vector<uint8_t>(root.begin(), root.end()) == referenceMTH(ref, 0, n));
+
+            std::vector<uint8_t> blob = tree.serialize();
+            SM3MerkleTree loaded;
+            bool ok = loaded.deserialize(blob.data(), blob.size());
+            assert(ok && loaded.size() == n && loaded.root() == tree.root());
+            bool truncated = loaded.deserialize(blob.data(), blob.size() - 1);
+            assert(!truncated && loaded.size() == n);
+        }
+        std::cout << "Test 10 - Merkle tree levels and serialization OK\n\n";
+    }
+
+    // 测试 11: 按下标的包含证明与合并证明（含重复叶子、篡改检测）
+    {
+        std::mt19937 rng(11);
+        for (size_t n = 1; n <= 40; ++n) {
+            std::vector<SM3MerkleTree::Digest> leaves(n);
+            for (size_t i = 0; i < n; ++i) leaves[i] = SM3MerkleTree::hashLeaf("leaf_" + std::to_string(i % 5));
+            SM3MerkleTree tree(leaves);
+            const SM3MerkleTree::Digest root = tree.root();
+
+            for (size_t i = 0; i < n; ++i) {
+                SM3MerkleTree::InclusionProof proof;
+                bool ok = tree.prove(i, proof);
+                assert(ok && SM3MerkleTree::verify(leaves[i], proof, root));
+                SM3MerkleTree::Digest other = SM3MerkleTree::hashLeaf("other");
+                assert(!SM3MerkleTree::verify(other, proof, root));
+                if (!proof.path.empty()) {
+                    SM3MerkleTree::InclusionProof bad = proof;
+                    bad.path[0].left = !bad.path[0].left;
+                    assert(!SM3MerkleTree::verify(leaves[i], bad, root));
+                    bad = proof;
+                    bad.path.back().hash[0] ^= 1;
+                    assert(!SM3MerkleTree::verify(leaves[i], bad, root));
+                    bad = proof;
+                    bad.index ^= 1;
+                    assert(bad.index >= n || !SM3MerkleTree::verify(leaves[i], bad, root));
+                }
+            }
+            SM3MerkleTree::InclusionProof none;
+            assert(!tree.prove(n, none));
+
+            for (int r = 0; r < 10; ++r) {
+                std::vector<uint64_t> idx(1 + rng() % n);
+                for (auto& v : idx) v = rng() % n;
+                SM3MerkleTree::MultiProof multi;
+                bool ok = tree.proveMany(idx, multi);
+                assert(ok && std::is_sorted(multi.indices.begin(), multi.indices.end()));
+                std::vector<SM3MerkleTree::Digest> subset;
+                for (uint64_t i : multi.indices) subset.push_back(leaves[i]);
+                assert(SM3MerkleTree::verifyMany(subset, multi, root));
+                if (!multi.nodes.empty()) {
+                    multi.nodes.pop_back();
+                    assert(!SM3MerkleTree::verifyMany(subset, multi, root));
+                }
+            }
+        }
+        std::cout << "Test 11 - Merkle inclusion proofs and multi-proofs OK\n\n";
+    }
+
+    // 测试 12: RFC 6962 透明日志——较早树大小的根与审计路径、一致性证明、有序叶子的不存在证明
+    {
+        std::mt19937 rng(12);
+        for (size_t n = 0; n <= 40; ++n) {
+            std::vector<SM3MerkleTree::Digest> leaves(n);
+            std::vector<std::vector<uint8_t>> ref(n);
+            for (size_t i = 0; i < n; ++i) {
+                leaves[i] = SM3MerkleTree::hashLeaf("entry_" + std::to_string(i));
+                ref[i].assign(leaves[i].begin(), leaves[i].end());
+            }
+            SM3MerkleTree tree(leaves);
+
+            for (size_t m = 0; m <= n; ++m) {
+                SM3MerkleTree::Digest oldRoot = tree.rootAt(m);
+                assert(std::vector<uint8_t>(oldRoot.begin(), oldRoot.end()) == referenceMTH(ref, 0, m));
+
+                // 旧树大小上的审计路径与单独建一棵 m 叶子的树得到的相同
+                SM3MerkleTree prefix(std::vector<SM3MerkleTree::Digest>(leaves.begin(), leaves.begin() + m));
+                for (size_t i = 0; i < m; ++i) {
+                    SM3MerkleTree::InclusionProof a, b;
+                    bool ok = tree.prove(i, m, a) && prefix.prove(i, b);
+                    assert(ok && a.path.size() == b.path.size());
+                    for (size_t k = 0; k < a.path.size(); ++k) {
+                        assert(a.path[k].hash == b.path[k].hash && a.path[k].left == b.path[k].left);
+                    }
+                    assert(SM3MerkleTree::verify(leaves[i], a, oldRoot));
+                }
+
+                SM3MerkleTree::ConsistencyProof cp;
+                bool ok = tree.proveConsistency(m, n, cp);
+                assert(ok && SM3MerkleTree::verifyConsistency(cp, oldRoot, tree.root()));
+                if (m > 0 && m < n) {
+                    SM3MerkleTree::Digest wrong = oldRoot;
+                    wrong[31] ^= 1;
+                    assert(!SM3MerkleTree::verifyConsistency(cp, wrong, tree.root()));
+                    if (!cp.nodes.empty()) {
+                        SM3MerkleTree::ConsistencyProof bad = cp;
+                        bad.nodes[rng() % bad.nodes.size()][0] ^= 0x80;
+                        assert(!SM3MerkleTree::verifyConsistency(bad, oldRoot, tree.root()));
+                        bad = cp;
+                        bad.nodes.pop_back();
+                        assert(!SM3MerkleTree::verifyConsistency(bad, oldRoot, tree.root()));
+                    }
+                    // 证明至多 O(log n) 个节点
+                    assert(cp.nodes.size() <= 2 * tree.height());
+                }
+            }
+            SM3MerkleTree::ConsistencyProof none;
+            assert(!tree.proveConsistency(n + 1, n + 1, none));
+
+            // 叶子按摘要排序后，对不在树中的摘要给出相邻叶子
+            std::vector<SM3MerkleTree::Digest> sorted = leaves;
+            std::sort(sorted.begin(), sorted.end());
+            SM3MerkleTree sortedTree(sorted);
+            for (size_t i = 0; i < n; ++i) {
+                SM3MerkleTree::NonInclusionProof np;
+                assert(!sortedTree.proveAbsent(sorted[i], np));
+            }
+            for (int r = 0; r < 20; ++r) {
+                SM3MerkleTree::Digest target = SM3MerkleTree::hashLeaf("absent_" + std::to_string(rng()));
+                SM3MerkleTree::NonInclusionProof np;
+                bool ok = sortedTree.proveAbsent(target, np);
+                assert(ok && SM3MerkleTree::verifyAbsent(target, np, sortedTree.root()));
+                // 证明只对夹在两个叶子之间的目标成立
+                if (np.hasLeft) assert(!SM3MerkleTree::verifyAbsent(np.left, np, sortedTree.root()));
+                if (np.hasLeft && np.hasRight) {
+                    SM3MerkleTree::NonInclusionProof gap = np;
+                    gap.hasRight = false;
+                    assert(!SM3MerkleTree::verifyAbsent(target, gap, sortedTree.root()));
+                }
+            }
+        }
+        std::cout << "Test 12 - RFC 6962 audit paths, consistency and non-inclusion proofs OK\n\n";
+    }
+
+    // 测试 13: 并行建树（线程池 + 多缓冲内核）与逐个节点串行计算的结果一致
+    {
+        ThreadPool pool3(3);
+        for (size_t n : {1000, 4097, 70001}) {
+            std::vector<std::string> records(n);
+            std::vector<const uint8_t*> ptrs(n);
+            std::vector<size_t> lens(n);
+            for (size_t i = 0; i < n; ++i) {
+                records[i] = "record_" + std::to_string(i) + std::string(i % 150, 'x');
+                ptrs[i] = reinterpret_cast<const uint8_t*>(records[i].data());
+                lens[i] = records[i].size();
+            }
+
+            std::vector<SM3MerkleTree::Digest> level(n);
+            for (size_t i = 0; i < n; ++i) level[i] = SM3MerkleTree::hashLeaf(records[i]);
+            std::vector<SM3MerkleTree::Digest> leaves = level;
+            while (level.size() > 1) {
+                std::vector<SM3MerkleTree::Digest> up;
+                for (size_t i = 0; i + 1 < level.size(); i += 2) {
+                    up.push_back(SM3MerkleTree::hashNode(level[i], level[i + 1]));
+                }
+                if (level.size() % 2) up.push_back(level.back());
+                level.swap(up);
+            }
+
+            SM3MerkleTree fromStrings(&pool3), fromPointers(&pool3);
+            fromStrings.build(records);
+            fromPointers.build(ptrs.data(), lens.data(), n);
+            SM3MerkleTree fromDigests(leaves, &pool3);
+            assert(fromStrings.root() == level[0]);
+            assert(fromPointers.root() == level[0]);
+            assert(fromDigests.root() == level[0]);
+            assert(fromStrings.level(0) == leaves);
+        }
+        std::cout << "Test 13 - parallel Merkle build OK\n\n";
+    }
+
+    // 测试 14: 增量追加与修改，结果与重新建树相同
+    {
+        ThreadPool pool3(3);
+        std::mt19937 rng(14);
+        auto sameAsRebuild = [&](const SM3MerkleTree& tree) {
+            SM3MerkleTree fresh(tree.level(0), &pool3);
+            if (fresh.root() != tree.root() || fresh.height() != tree.height()) return false;
+            for (size_t l = 0; (tree.size() >> l) > 0; ++l) {
+                if (fresh.level(l) != tree.level(l)) return false;
+            }
+            return true;
+        };
+
+        SM3MerkleTree tree(&pool3);
+        for (size_t i = 0; i < 300; ++i) {
+            SM3MerkleTree::Digest oldRoot = tree.root();
+            tree.append(SM3MerkleTree::hashLeaf("append_" + std::to_string(i)));
+            assert(sameAsRebuild(tree));
+            SM3MerkleTree::ConsistencyProof cp;
+            bool ok = tree.proveConsistency(i, i + 1, cp);
+            assert(ok && SM3MerkleTree::verifyConsistency(cp, oldRoot, tree.root()));
+        }
+        for (int r = 0; r < 8; ++r) {
+            std::vector<SM3MerkleTree::Digest> batch(rng() % 5000);
+            for (auto& d : batch) d = SM3MerkleTree::hashLeaf("batch_" + std::to_string(rng()));
+            tree.append(batch);
+            assert(sameAsRebuild(tree));
+        }
+
+        size_t n = tree.size();
+        for (int r = 0; r < 50; ++r) {
+            size_t i = rng() % n;
+            bool ok = tree.update(i, SM3MerkleTree::hashLeaf("update_" + std::to_string(r)));
+            assert(ok && sameAsRebuild(tree));
+        }
+        for (size_t count : {1, 7, 500, 20000}) {
+            std::vector<std::pair<uint64_t, SM3MerkleTree::Digest>> changes(count);
+            std::vector<SM3MerkleTree::Digest> expected = tree.level(0);
+            for (auto& c : changes) {
+                c = {rng() % n, SM3MerkleTree::hashLeaf("batch_update_" + std::to_string(rng()))};
+                expected[c.first] = c.second;   // 重复下标以最后一次为准
+            }
+            bool ok = tree.update(changes);
+            assert(ok && tree.level(0) == expected && sameAsRebuild(tree));
+        }
+
+        SM3MerkleTree::Digest before = tree.root();
+        std::vector<std::pair<uint64_t, SM3MerkleTree::Digest>> bad = {{0, before}, {n, before}};
+        assert(!tree.update(bad) && !tree.update(n, before) && tree.root() == before);
+
+        SM3MerkleTree::InclusionProof proof;
+        bool ok = tree.prove(n - 1, proof);
+        assert(ok && SM3MerkleTree::verify(tree.leaf(n - 1), proof, tree.root()));
+        std::cout << "Test 14 - incremental Merkle append and update (" << n << " leaves) OK\n\n";
+    }
 
     std::cout << "所有测试通过！" << std::endl;
     return 0;
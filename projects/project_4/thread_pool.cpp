@@ -0,0 +1,75 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+        if (threads == 0) threads = 1;
+    }
+    for (unsigned i = 1; i < threads; ++i) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cvWork.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+void ThreadPool::workerLoop() {
+    unsigned long seen = 0;
+    std::unique_lock<std::mutex> lock(mtx);
+    for (;;) {
+        cvWork.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping) return;
+        seen = generation;
+        // 逐个领取任务，执行时释放锁
+        while (nextTask < jobTasks) {
+            size_t i = nextTask++;
+            const auto* fn = job;
+            lock.unlock();
+            (*fn)(i);
+            lock.lock();
+            if (++doneTasks == jobTasks) cvDone.notify_all();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(size_t tasks, const std::function<void(size_t)>& fn) {
+    if (tasks == 0) return;
+    if (workers.empty() || tasks == 1) {
+        for (size_t i = 0; i < tasks; ++i) fn(i);
+        return;
+    }
+
+    // 同一时刻只允许一个 parallelFor 占用线程池
+    std::lock_guard<std::mutex> submit(submitMtx);
+
+    std::unique_lock<std::mutex> lock(mtx);
+    job = &fn;
+    jobTasks = tasks;
+    nextTask = 0;
+    doneTasks = 0;
+    ++generation;
+    cvWork.notify_all();
+
+    // 调用线程同样参与
+    while (nextTask < jobTasks) {
+        size_t i = nextTask++;
+        lock.unlock();
+        fn(i);
+        lock.lock();
+        ++doneTasks;
+    }
+    cvDone.wait(lock, [&] { return doneTasks == jobTasks; });
+    job = nullptr;
+    jobTasks = 0;
+}
+
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
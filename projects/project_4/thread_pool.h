@@ -0,0 +1,52 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * ThreadPool
+ * 固定数量的工作线程，用于把互相独立的工作（树哈希的叶子分块、多个文件等）分发到多核
+ * parallelFor 阻塞直到所有任务完成；调用线程自身也参与执行任务
+ * 任务内不可再次调用同一线程池的 parallelFor
+ */
+class ThreadPool {
+public:
+    // threads 为 0 时取硬件并发数
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 总线程数（含调用线程）
+    unsigned size() const { return unsigned(workers.size()) + 1; }
+
+    // 对 i = 0 .. tasks-1 并行执行 fn(i)
+    void parallelFor(size_t tasks, const std::function<void(size_t)>& fn);
+
+    // 进程内共享的线程池，首次使用时创建
+    static ThreadPool& global();
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::mutex submitMtx;
+    std::mutex mtx;
+    std::condition_variable cvWork;
+    std::condition_variable cvDone;
+
+    const std::function<void(size_t)>* job = nullptr;
+    size_t jobTasks = 0;
+    size_t nextTask = 0;
+    size_t doneTasks = 0;
+    unsigned long generation = 0;
+    bool stopping = false;
+};
+
+#endif // THREAD_POOL_H